@@ -0,0 +1,132 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include "importPointClouds.h"
+#include "voxelDownsampling.h"
+#include "writePointClouds.h"
+#include "pds_option.h"
+
+#include <kvs/PolygonObject>
+
+const char OUT_FILE[] = "../XYZ_DATA/out_ds.xyz";
+
+//--- Check the extension of the output file
+bool hasExtension( const char* filename, const char* ext )
+{
+  size_t len = strlen( filename );
+  size_t elen = strlen( ext );
+  return ( len >= elen && !strcmp( filename + len - elen, ext ) );
+}
+
+int main( int argc, char** argv )
+{
+  char outfile[512];
+  strcpy( outfile, OUT_FILE );
+  if( argc < 2 ) {
+    std::cout << "USAGE   : " << argv[0] << " [input_point_cloud_data] [output_point_cloud_data] [options]" << std::endl;
+    std::cout << "EXAMPLE : " << argv[0] << " [input_point_cloud.ply] [output_point_cloud.spbr]" << std::endl;
+    std::cout << "OPTIONS : " << VOXEL_SIZE_OPTION << " size (voxel size), "
+              << BINARY_OUTPUT_OPTION << " (binary output for .spbr/.xyz)" << std::endl;
+    std::cout << "          " << FEATURE_THRESHOLD_OPTION << " f_th (keep points with ft >= f_th), "
+              << ALPHA_OPTION << " alpha " << PIXEL_WIDTH_OPTION << " L (voxel size for opacity alpha at pixel width L)" << std::endl;
+    std::cout << "FORMAT  : .ply -> PLY (ascii), .spbr -> SPBR, others -> XYZ (x y z nx ny nz r g b f)" << std::endl;
+    exit( 1 );
+  }
+
+  //---- Command-line Option
+  double voxelSize = 0.0;
+  double threshold = -1.0;
+  double alpha = 0.0, pixelWidth = 0.0;
+  WritingDataType type = Ascii;
+  for( int i = 2; i < argc; i++ ) {
+    if( !strcmp( VOXEL_SIZE_OPTION, argv[i] ) && i + 1 < argc ) {
+      voxelSize = atof( argv[i+1] );
+      i++;
+    }
+    else if( !strcmp( BINARY_OUTPUT_OPTION, argv[i] ) ) {
+      type = Binary;
+    }
+    else if( !strcmp( FEATURE_THRESHOLD_OPTION, argv[i] ) && i + 1 < argc ) {
+      threshold = atof( argv[i+1] );
+      i++;
+    }
+    else if( !strcmp( ALPHA_OPTION, argv[i] ) && i + 1 < argc ) {
+      alpha = atof( argv[i+1] );
+      i++;
+    }
+    else if( !strcmp( PIXEL_WIDTH_OPTION, argv[i] ) && i + 1 < argc ) {
+      pixelWidth = atof( argv[i+1] );
+      i++;
+    }
+    else if( argv[i][0] == '-' ) {
+      //--- Unknown option, or an option without its argument
+      std::cout << "ERROR: Unknown option or missing argument: " << argv[i] << std::endl;
+      exit(1);
+    }
+    else {
+      if( strlen( argv[i] ) >= sizeof( outfile ) ) {
+        std::cout << "ERROR: Output file name is too long: " << argv[i] << std::endl;
+        exit(1);
+      }
+      strncpy( outfile, argv[i], sizeof( outfile ) - 1 );
+      outfile[ sizeof( outfile ) - 1 ] = '\0';
+    }
+  }
+
+  //--- Inheritance of KVS::PolygonObject
+  ImportPointClouds *ply = new ImportPointClouds( argv[1] );
+  ply->updateMinMaxCoords();
+  std::cout << "PLY Mim, Max Coords:" << std::endl;
+  std::cout << "Min : " << ply->minObjectCoord() << std::endl;
+  std::cout << "Max : " << ply->maxObjectCoord() << std::endl;
+  std::cout << std::endl;
+
+  //--- Voxel size
+  //    Opacity alpha needs -ln(1-alpha)/L^2 points per unit area in each
+  //    of the LR ensembles ( L: pixel width printed by alphaControl4ply )
+  if( voxelSize <= 0.0 && alpha > 0.0 && alpha < 1.0 && pixelWidth > 0.0 ) {
+    voxelSize = pixelWidth / sqrt( -log( 1.0 - alpha ) );
+    std::cout << "Voxel size for opacity " << alpha << " ( L = " << pixelWidth << " )" << std::endl;
+  }
+  if( voxelSize <= 0.0 ) {
+    double voxel_size_inv;
+    double diag = ( ply->maxObjectCoord() - ply->minObjectCoord() ).length();
+    std::cout << "Voxel size" << std::endl;
+    std::cout << "Input 1/voxel_size (voxel_size = bounding-box diagonal / input) >> ";
+    std::cin >> voxel_size_inv;
+    if( voxel_size_inv <= 0.0 ) {
+      std::cout << "ERROR: 1/voxel_size must be positive" << std::endl;
+      exit(1);
+    }
+    voxelSize = diag / voxel_size_inv;
+  }
+  std::cout << "Voxel size ==> " << voxelSize << std::endl;
+  std::cout << std::endl;
+
+  //--- Downsampling
+  std::vector<float> ft = ply->featureData();
+  voxelDownsampling *ds;
+  if( threshold >= 0.0 )
+    ds = new voxelDownsampling( ply, ft, voxelSize, threshold );
+  else
+    ds = new voxelDownsampling( ply, ft, voxelSize );
+
+  //--- Output
+  if( hasExtension( outfile, ".ply" ) ) {
+    writePLY( ds, outfile );
+  }
+  else if( hasExtension( outfile, ".spbr" ) ) {
+    writeSPBR( ds, outfile, type );
+  }
+  else {
+    std::vector<float> dsft = ds->featureData();
+    if( dsft.size() != ds->numberOfVertices() )
+      dsft.assign( ds->numberOfVertices(), 0.0f );
+    writeFeature( ds, dsft, outfile, type );
+    std::cout << "** File " << outfile << "  is generated." << std::endl;
+  }
+
+  return 0;
+}
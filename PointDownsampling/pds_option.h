@@ -0,0 +1,10 @@
+#ifndef _pds_option_H__
+#define _pds_option_H__
+
+const char VOXEL_SIZE_OPTION[]        = "-vs";
+const char BINARY_OUTPUT_OPTION[]     = "-b";
+const char FEATURE_THRESHOLD_OPTION[] = "-ft";
+const char ALPHA_OPTION[]             = "-a";
+const char PIXEL_WIDTH_OPTION[]       = "-L";
+
+#endif
@@ -0,0 +1,190 @@
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+#include "voxelDownsampling.h"
+#include "parallelSortKeys.h"
+
+const int KEY_BITS = 21;                                  // Bits per axis of a voxel key
+const unsigned long long KEY_MAX = ( 1ULL << KEY_BITS );  // Maximum number of voxels per axis
+
+voxelDownsampling::voxelDownsampling( void ):
+  m_voxelSize( 0.0 ),
+  m_threshold( 0.0 ),
+  m_isFeatureAware( false )
+{  }
+
+voxelDownsampling::voxelDownsampling( kvs::PolygonObject* ply,
+                                      std::vector<float> &ft,
+                                      double voxelSize ):
+  m_voxelSize( voxelSize ),
+  m_threshold( 0.0 ),
+  m_isFeatureAware( false )
+{
+  SuperClass::setPolygonType( kvs::PolygonObject::UnknownPolygonType );
+  SuperClass::setColorType( kvs::PolygonObject::VertexColor );
+  SuperClass::setNormalType( kvs::PolygonObject::VertexNormal );
+
+  exec( ply, ft );
+}
+
+voxelDownsampling::voxelDownsampling( kvs::PolygonObject* ply,
+                                      std::vector<float> &ft,
+                                      double voxelSize,
+                                      double threshold ):
+  m_voxelSize( voxelSize ),
+  m_threshold( threshold ),
+  m_isFeatureAware( true )
+{
+  if( ft.size() != ply->numberOfVertices() ) {
+    std::cout << "ERROR: Feature-aware downsampling needs feature values ( XYZ data from pfe )" << std::endl;
+    exit(1);
+  }
+
+  SuperClass::setPolygonType( kvs::PolygonObject::UnknownPolygonType );
+  SuperClass::setColorType( kvs::PolygonObject::VertexColor );
+  SuperClass::setNormalType( kvs::PolygonObject::VertexNormal );
+
+  exec( ply, ft );
+}
+
+void voxelDownsampling::exec( kvs::PolygonObject* ply, std::vector<float> &ft )
+{
+  size_t numVert = ply->numberOfVertices();
+  if( numVert == 0 || m_voxelSize <= 0.0 ) {
+    std::cout << "ERROR: Invalid input for voxel downsampling" << std::endl;
+    exit(1);
+  }
+  bool hasNormal  = ( ply->numberOfNormals() == numVert );
+  bool hasColor   = ( ply->numberOfColors() == numVert );
+  bool hasFeature = ( ft.size() == numVert );
+
+  kvs::ValueArray<kvs::Real32> coords  = ply->coords();
+  kvs::ValueArray<kvs::Real32> normals = ply->normals();
+  kvs::ValueArray<kvs::UInt8>  colors  = ply->colors();
+  const float *pcoords = coords.data();
+
+  //--- Bounding box ( computed here, since the readers differ in how they set it )
+  float minX = pcoords[0], minY = pcoords[1], minZ = pcoords[2];
+  float maxX = pcoords[0], maxY = pcoords[1], maxZ = pcoords[2];
+#pragma omp parallel for reduction(min:minX,minY,minZ) reduction(max:maxX,maxY,maxZ)
+  for( long i = 0; i < (long)numVert; i++ ) {
+    minX = std::min( minX, pcoords[3*i] );
+    minY = std::min( minY, pcoords[3*i+1] );
+    minZ = std::min( minZ, pcoords[3*i+2] );
+    maxX = std::max( maxX, pcoords[3*i] );
+    maxY = std::max( maxY, pcoords[3*i+1] );
+    maxZ = std::max( maxZ, pcoords[3*i+2] );
+  }
+
+  double dimension[3] = { ( maxX - minX ) / m_voxelSize,
+                          ( maxY - minY ) / m_voxelSize,
+                          ( maxZ - minZ ) / m_voxelSize };
+  for( int k = 0; k < 3; k++ ) {
+    if( dimension[k] >= (double)( KEY_MAX - 1 ) ) {
+      std::cout << "ERROR: Voxel size is too small ( more than "
+                << KEY_MAX - 1 << " voxels per axis )" << std::endl;
+      exit(1);
+    }
+  }
+
+  //--- Points to be downsampled ( feature points are kept in feature-aware mode )
+  std::vector<size_t> sampled, kept;
+  if( m_isFeatureAware ) {
+    for( size_t i = 0; i < numVert; i++ ) {
+      if( ft[i] >= m_threshold ) kept.push_back( i );
+      else                       sampled.push_back( i );
+    }
+    std::cout << "Feature threshold: " << m_threshold << " ( "
+              << kept.size() << " feature points are kept )" << std::endl;
+  }
+  size_t numSampled = m_isFeatureAware ? sampled.size() : numVert;
+
+  //--- Voxel key of each point
+  std::cout << "Calculating voxel keys..." << std::endl;
+  std::vector< std::pair<unsigned long long, size_t> > keys( numSampled );
+#pragma omp parallel for
+  for( long j = 0; j < (long)numSampled; j++ ) {
+    size_t i = m_isFeatureAware ? sampled[j] : (size_t)j;
+    unsigned long long ix = (unsigned long long)( ( pcoords[3*i]   - minX ) / m_voxelSize );
+    unsigned long long iy = (unsigned long long)( ( pcoords[3*i+1] - minY ) / m_voxelSize );
+    unsigned long long iz = (unsigned long long)( ( pcoords[3*i+2] - minZ ) / m_voxelSize );
+    keys[j].first  = ( ix << ( 2 * KEY_BITS ) ) | ( iy << KEY_BITS ) | iz;
+    keys[j].second = i;
+  }
+
+  std::cout << "Sorting voxel keys..." << std::endl;
+  parallelSortKeys( keys );
+
+  //--- First entry of each occupied voxel
+  std::vector<size_t> voxelStart;
+  voxelStart.reserve( numSampled / 4 + 1 );
+  for( size_t i = 0; i < numSampled; i++ ) {
+    if( i == 0 || keys[i].first != keys[i-1].first )
+      voxelStart.push_back( i );
+  }
+  size_t numVoxel = voxelStart.size();
+  voxelStart.push_back( numSampled );
+
+  //--- Average attributes per voxel ( kept points follow the voxel points )
+  std::cout << "Averaging attributes..." << std::endl;
+  size_t numOut = numVoxel + kept.size();
+  kvs::ValueArray<kvs::Real32> voxelCoords( 3 * numOut );
+  kvs::ValueArray<kvs::Real32> voxelNormals( hasNormal ? 3 * numOut : 0 );
+  kvs::ValueArray<kvs::UInt8>  voxelColors( hasColor ? 3 * numOut : 0 );
+  m_ft.assign( hasFeature ? numOut : 0, 0.0f );
+
+#pragma omp parallel for schedule(dynamic, 1024)
+  for( long v = 0; v < (long)numVoxel; v++ ) {
+    double p[3] = { 0.0, 0.0, 0.0 };
+    double n[3] = { 0.0, 0.0, 0.0 };
+    double c[3] = { 0.0, 0.0, 0.0 };
+    double f = 0.0;
+    size_t begin = voxelStart[v];
+    size_t end   = voxelStart[v+1];
+    for( size_t j = begin; j < end; j++ ) {
+      size_t id = keys[j].second;
+      for( int k = 0; k < 3; k++ ) {
+        p[k] += pcoords[3*id+k];
+        if( hasNormal ) n[k] += normals[3*id+k];
+        if( hasColor )  c[k] += colors[3*id+k];
+      }
+      if( hasFeature ) f += ft[id];
+    }
+    double inv = 1.0 / (double)( end - begin );
+    for( int k = 0; k < 3; k++ )
+      voxelCoords[3*v+k] = (kvs::Real32)( p[k] * inv );
+    if( hasNormal ) {
+      double len = sqrt( n[0]*n[0] + n[1]*n[1] + n[2]*n[2] );
+      if( len > 0.0 ) len = 1.0 / len;
+      for( int k = 0; k < 3; k++ )
+        voxelNormals[3*v+k] = (kvs::Real32)( n[k] * len );
+    }
+    if( hasColor ) {
+      for( int k = 0; k < 3; k++ )
+        voxelColors[3*v+k] = (kvs::UInt8)( c[k] * inv + 0.5 );
+    }
+    if( hasFeature ) m_ft[v] = (float)( f * inv );
+  }
+
+#pragma omp parallel for
+  for( long j = 0; j < (long)kept.size(); j++ ) {
+    size_t id = kept[j];
+    size_t v = numVoxel + j;
+    for( int k = 0; k < 3; k++ ) {
+      voxelCoords[3*v+k] = pcoords[3*id+k];
+      if( hasNormal ) voxelNormals[3*v+k] = normals[3*id+k];
+      if( hasColor )  voxelColors[3*v+k]  = colors[3*id+k];
+    }
+    m_ft[v] = ft[id];
+  }
+
+  SuperClass::setCoords( voxelCoords );
+  SuperClass::setNormals( voxelNormals );
+  SuperClass::setColors( voxelColors );
+
+  std::cout << "Voxel size      : " << m_voxelSize << std::endl;
+  std::cout << "Number of points: " << numVert << " -> " << numOut
+            << " ( " << 100.0 * (double)numOut / (double)numVert << " % )" << std::endl;
+}
@@ -0,0 +1,41 @@
+#ifndef _voxelDownsampling_H__
+#define _voxelDownsampling_H__
+
+#include <kvs/Module>
+#include <kvs/PolygonObject>
+#include <vector>
+#include <utility>
+
+//--- Uniform voxel-grid downsampling
+//    Points falling into the same voxel are replaced by one point whose
+//    coordinates, normals, colors ( and features ) are the voxel averages.
+//    With a feature threshold, points with ft >= threshold are kept as they
+//    are and only the low-feature points are downsampled.
+class voxelDownsampling: public kvs::PolygonObject {
+  kvsModuleSuperClass( kvs::PolygonObject );
+
+ public:
+  voxelDownsampling( void );
+  voxelDownsampling( kvs::PolygonObject* ply,
+                     std::vector<float> &ft,
+                     double voxelSize );
+  voxelDownsampling( kvs::PolygonObject* ply,
+                     std::vector<float> &ft,
+                     double voxelSize,
+                     double threshold );
+
+ private:
+  void exec( kvs::PolygonObject* ply, std::vector<float> &ft );
+
+ private:
+  double m_voxelSize;
+  double m_threshold;
+  bool m_isFeatureAware;
+  std::vector<float> m_ft;
+
+ public:
+  double voxelSize( void ) { return m_voxelSize; }
+  std::vector<float> featureData( void ) { return m_ft; }
+};
+
+#endif
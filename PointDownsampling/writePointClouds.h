@@ -0,0 +1,105 @@
+#ifndef _writePointClouds_H__
+#define _writePointClouds_H__
+
+#include <kvs/PolygonObject>
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include "spcomment.h"
+#include "writeFeature.h"
+
+const kvs::UInt8 DEFAULT_COLOR[3] = { 255, 255, 255 };
+
+//--- SPBR format ( x y z nx ny nz r g b )
+void writeSPBR( kvs::PolygonObject *ply,
+                char* filename,
+                WritingDataType type = Ascii )
+{
+  size_t num = ply->numberOfVertices();
+  bool hasNormal = ( num == ply->numberOfNormals() );
+  bool hasColor  = ( num == ply->numberOfColors() );
+  kvs::ValueArray<kvs::Real32> coords  = ply->coords();
+  kvs::ValueArray<kvs::Real32> normals = ply->normals();
+  kvs::ValueArray<kvs::UInt8>  colors  = ply->colors();
+
+  std::ofstream fout( filename, std::ios::binary );
+  if( !fout ) {
+    std::cerr << "ERROR: Cannot Open File " << filename << std::endl;
+    exit(1);
+  }
+  if( type == Binary ) fout << SPBR_BINARY_DATA_COMMAND << std::endl;
+  else                 fout << SPBR_ASCII_DATA_COMMAND << std::endl;
+  fout << NUM_PARTICLES_COMMAND << " " << num << std::endl;
+  fout << END_HEADER_COMMAND << std::endl;
+
+  for( size_t i=0; i<num; i++ ) {
+    kvs::Real32 n[3] = { NORMAL[0], NORMAL[1], NORMAL[2] };
+    kvs::UInt8  c[3] = { DEFAULT_COLOR[0], DEFAULT_COLOR[1], DEFAULT_COLOR[2] };
+    for( int k=0; k<3; k++ ) {
+      if( hasNormal ) n[k] = normals[3*i+k];
+      if( hasColor )  c[k] = colors[3*i+k];
+    }
+    if( type == Binary ) {
+      fout.write( (char*)&coords[3*i], sizeof(kvs::Real32)*3 );
+      fout.write( (char*)n, sizeof(kvs::Real32)*3 );
+      fout.write( (char*)c, sizeof(kvs::UInt8)*3 );
+    }
+    else {
+      fout << coords[3*i] << " " << coords[3*i+1] << " " << coords[3*i+2] << " "
+           << n[0] << " " << n[1] << " " << n[2] << " "
+           << (int)c[0] << " " << (int)c[1] << " " << (int)c[2] << std::endl;
+    }
+  }
+
+  fout.close();
+  std::cout << "** File " << filename << "  is generated." << std::endl;
+}
+
+//--- PLY format ( ascii, vertices only )
+void writePLY( kvs::PolygonObject *ply,
+               char* filename )
+{
+  size_t num = ply->numberOfVertices();
+  bool hasNormal = ( num == ply->numberOfNormals() );
+  bool hasColor  = ( num == ply->numberOfColors() );
+  kvs::ValueArray<kvs::Real32> coords  = ply->coords();
+  kvs::ValueArray<kvs::Real32> normals = ply->normals();
+  kvs::ValueArray<kvs::UInt8>  colors  = ply->colors();
+
+  std::ofstream fout( filename );
+  if( !fout ) {
+    std::cerr << "ERROR: Cannot Open File " << filename << std::endl;
+    exit(1);
+  }
+  fout << "ply" << std::endl;
+  fout << "format ascii 1.0" << std::endl;
+  fout << "element vertex " << num << std::endl;
+  fout << "property float x" << std::endl;
+  fout << "property float y" << std::endl;
+  fout << "property float z" << std::endl;
+  if( hasNormal ) {
+    fout << "property float nx" << std::endl;
+    fout << "property float ny" << std::endl;
+    fout << "property float nz" << std::endl;
+  }
+  if( hasColor ) {
+    fout << "property uchar red" << std::endl;
+    fout << "property uchar green" << std::endl;
+    fout << "property uchar blue" << std::endl;
+  }
+  fout << "end_header" << std::endl;
+
+  for( size_t i=0; i<num; i++ ) {
+    fout << coords[3*i] << " " << coords[3*i+1] << " " << coords[3*i+2];
+    if( hasNormal )
+      fout << " " << normals[3*i] << " " << normals[3*i+1] << " " << normals[3*i+2];
+    if( hasColor )
+      fout << " " << (int)colors[3*i] << " " << (int)colors[3*i+1] << " " << (int)colors[3*i+2];
+    fout << std::endl;
+  }
+
+  fout.close();
+  std::cout << "** File " << filename << "  is generated." << std::endl;
+}
+
+#endif
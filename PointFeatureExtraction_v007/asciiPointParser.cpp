@@ -0,0 +1,313 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "asciiPointParser.h"
+
+const int MAX_SIGNIFICANT_DIGITS = 19;                  // Digits kept in the mantissa
+const unsigned long long MAX_EXACT_MANTISSA = 1ULL << 53;
+const int MAX_EXACT_EXPONENT = 22;                      // 10^22 is exact in double
+const double POW10[ MAX_EXACT_EXPONENT + 1 ] = {
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+const size_t CHUNKS_PER_THREAD = 4;
+const size_t MIN_CHUNK_BYTES   = 1 << 20;
+const int MAX_VALUES           = 32;                    // Values read from a data line
+
+static bool isSpace( char c )
+{
+  return ( c == ' ' || c == '\t' || c == '\r' );
+}
+
+static bool isDigit( char c )
+{
+  return ( c >= '0' && c <= '9' );
+}
+
+//--- Decimal word [p, end) with a mantissa below 2^53 and |exponent| <= 22:
+//    one correctly rounded operation gives the same value as strtod
+//    false: the word is left to strtod
+static bool parseDecimal( const char* p, const char* end, double &value )
+{
+  bool isNegative = false;
+  if( p < end && ( *p == '-' || *p == '+' ) ) {
+    isNegative = ( *p == '-' );
+    p++;
+  }
+
+  unsigned long long mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+  bool hasDigit = false;
+  for( ; p < end && isDigit( *p ); p++ ) {
+    hasDigit = true;
+    if( mantissa == 0 && *p == '0' )
+      continue;
+    if( ++digits > MAX_SIGNIFICANT_DIGITS )
+      return false;
+    mantissa = mantissa * 10 + ( *p - '0' );
+  }
+  if( p < end && *p == '.' ) {
+    for( p++; p < end && isDigit( *p ); p++ ) {
+      hasDigit = true;
+      exponent--;
+      if( mantissa == 0 && *p == '0' )
+        continue;
+      if( ++digits > MAX_SIGNIFICANT_DIGITS )
+        return false;
+      mantissa = mantissa * 10 + ( *p - '0' );
+    }
+  }
+  if( !hasDigit )
+    return false;
+  if( p < end && ( *p == 'e' || *p == 'E' ) ) {
+    p++;
+    bool isNegativeExponent = false;
+    if( p < end && ( *p == '-' || *p == '+' ) ) {
+      isNegativeExponent = ( *p == '-' );
+      p++;
+    }
+    if( p == end || !isDigit( *p ) )
+      return false;
+    int e = 0;
+    for( ; p < end && isDigit( *p ); p++ )
+      if( e < 10000 )
+        e = e * 10 + ( *p - '0' );
+    exponent += isNegativeExponent ? -e : e;
+  }
+  if( p != end )
+    return false;
+
+  if( mantissa == 0 ) {
+    value = isNegative ? -0.0 : 0.0;
+    return true;
+  }
+  if( mantissa > MAX_EXACT_MANTISSA || exponent < -MAX_EXACT_EXPONENT || exponent > MAX_EXACT_EXPONENT )
+    return false;
+  double v = (double)mantissa;
+  v = ( exponent >= 0 ) ? v * POW10[exponent] : v / POW10[-exponent];
+  value = isNegative ? -v : v;
+  return true;
+}
+
+//--- Value of a word ( the same as atof )
+static double parseWord( const char* p, const char* end )
+{
+  double value;
+  if( parseDecimal( p, end, value ) )
+    return value;
+
+  char buf[64];
+  size_t length = end - p;
+  if( length < sizeof(buf) ) {
+    memcpy( buf, p, length );
+    buf[length] = '\0';
+    return strtod( buf, NULL );
+  }
+  std::string word( p, end );
+  return strtod( word.c_str(), NULL );
+}
+
+asciiPointParser::asciiPointParser( const char* filename ):
+  m_filename( filename ),
+  m_data( "" ),
+  m_size( 0 ),
+  m_isMapped( false )
+{
+  int fd = open( filename, O_RDONLY );
+  struct stat st;
+  if( fd < 0 || fstat( fd, &st ) != 0 ) {
+    std::cout << "ERROR: Cannot Open File: " << filename << std::endl;
+    exit(1);
+  }
+  m_size = (size_t)st.st_size;
+
+  if( m_size > 0 ) {
+    void *addr = mmap( NULL, m_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    if( addr != MAP_FAILED ) {
+      m_data = (const char*)addr;
+      m_isMapped = true;
+    }
+    else {
+      //--- Contents read into memory
+      m_buffer.resize( m_size );
+      size_t done = 0;
+      while( done < m_size ) {
+        ssize_t n = read( fd, &m_buffer[done], m_size - done );
+        if( n <= 0 )
+          break;
+        done += n;
+      }
+      m_size = done;
+      m_data = m_buffer.empty() ? "" : &m_buffer[0];
+    }
+  }
+  close( fd );
+}
+
+asciiPointParser::~asciiPointParser( void )
+{
+  if( m_isMapped )
+    munmap( (void*)m_data, m_size );
+}
+
+const char* asciiPointParser::lineEnd( const char* p, const char* end )
+{
+  const char* nl = (const char*)memchr( p, '\n', end - p );
+  return ( nl != NULL ) ? nl : end;
+}
+
+//--- Not blank and not a comment ( # )
+bool asciiPointParser::isDataLine( const char* p, const char* end )
+{
+  if( end > p && end[-1] == '\r' )
+    end--;
+  return ( end > p && *p != '#' );
+}
+
+//--- Offset of the line after the first line beginning with prefix ( size of the file: none )
+size_t asciiPointParser::lineAfter( const char* prefix )
+{
+  size_t length = strlen( prefix );
+  const char* end = m_data + m_size;
+  for( const char* p = m_data; p < end; ) {
+    const char* e = lineEnd( p, end );
+    if( (size_t)( e - p ) >= length && !strncmp( p, prefix, length ) )
+      return std::min( m_size, (size_t)( e - m_data ) + 1 );
+    p = e + 1;
+  }
+  return m_size;
+}
+
+//--- Data lines from offset ( at most maxPoints ), counted per chunk
+size_t asciiPointParser::countPoints( size_t offset, size_t maxPoints )
+{
+  const char* begin = m_data + std::min( offset, m_size );
+  const char* end   = m_data + m_size;
+
+  //--- A limited region ends after its last data line ( e.g. vertices before faces )
+  if( maxPoints != ALL_LINES ) {
+    size_t n = 0;
+    const char* p = begin;
+    while( p < end && n < maxPoints ) {
+      const char* e = lineEnd( p, end );
+      if( isDataLine( p, e ) )
+        n++;
+      p = std::min( e + 1, end );
+    }
+    end = p;
+  }
+
+  size_t numChunks = 1;
+#ifdef _OPENMP
+  numChunks = CHUNKS_PER_THREAD * omp_get_max_threads();
+#endif
+  size_t length = end - begin;
+  numChunks = std::max( (size_t)1, std::min( numChunks, length / MIN_CHUNK_BYTES ) );
+
+  //--- Chunks begin at the beginning of a line
+  m_chunkBegin.assign( numChunks + 1, begin - m_data );
+  m_chunkBegin[numChunks] = end - m_data;
+  for( size_t c = 1; c < numChunks; c++ ) {
+    const char* p = begin + length * c / numChunks;
+    const char* nl = (const char*)memchr( p - 1, '\n', end - ( p - 1 ) );
+    p = ( nl != NULL ) ? nl + 1 : end;
+    m_chunkBegin[c] = std::max( m_chunkBegin[c - 1], (size_t)( p - m_data ) );
+  }
+
+  m_chunkFirst.assign( numChunks + 1, 0 );
+#pragma omp parallel for schedule(dynamic, 1)
+  for( long c = 0; c < (long)numChunks; c++ ) {
+    const char* p  = m_data + m_chunkBegin[c];
+    const char* ce = m_data + m_chunkBegin[c + 1];
+    size_t n = 0;
+    while( p < ce ) {
+      const char* e = lineEnd( p, ce );
+      if( isDataLine( p, e ) )
+        n++;
+      p = e + 1;
+    }
+    m_chunkFirst[c + 1] = n;
+  }
+  for( size_t c = 0; c < numChunks; c++ )
+    m_chunkFirst[c + 1] += m_chunkFirst[c];
+  return m_chunkFirst[numChunks];
+}
+
+//--- Points of the region of countPoints() into the arrays ( allocated for its count )
+void asciiPointParser::parsePoints( const Layout &layout, PointArrays &arrays )
+{
+  int maxValues = layout.coord + 3;
+  if( layout.normal >= 0 )  maxValues = std::max( maxValues, layout.normal + 3 );
+  if( layout.color >= 0 )   maxValues = std::max( maxValues, layout.color + 3 );
+  if( layout.feature >= 0 ) maxValues = std::max( maxValues, layout.feature + 1 );
+  maxValues = std::min( std::max( maxValues, layout.minWords ), MAX_VALUES );
+
+  size_t numChunks = m_chunkBegin.empty() ? 0 : m_chunkBegin.size() - 1;
+#pragma omp parallel for schedule(dynamic, 1)
+  for( long c = 0; c < (long)numChunks; c++ ) {
+    const char* p  = m_data + m_chunkBegin[c];
+    const char* ce = m_data + m_chunkBegin[c + 1];
+    size_t i = m_chunkFirst[c];
+    double v[ MAX_VALUES ];
+    while( p < ce ) {
+      const char* e = lineEnd( p, ce );
+      if( !isDataLine( p, e ) ) {
+        p = e + 1;
+        continue;
+      }
+      int nw = parseLine( p, e, v, maxValues );
+      if( nw < layout.minWords ) {
+#pragma omp critical
+        {
+          std::cout << "ERROR: " << nw << " values on a data line of " << m_filename << std::endl;
+          exit(1);
+        }
+      }
+
+      for( int k = 0; k < 3; k++ ) {
+        if( arrays.coords != NULL )
+          arrays.coords[3*i+k] = (float)v[ layout.coord + k ];
+        if( arrays.normals != NULL )
+          arrays.normals[3*i+k] = ( layout.normal >= 0 && nw >= layout.normal + 3 ) ?
+            (float)v[ layout.normal + k ] : layout.defaultNormal[k];
+        if( arrays.colors != NULL )
+          arrays.colors[3*i+k] = ( layout.color >= 0 && nw >= layout.color + 3 ) ?
+            (unsigned char)(long)v[ layout.color + k ] : layout.defaultColor[k];
+      }
+      if( arrays.features != NULL )
+        arrays.features[i] = ( layout.feature >= 0 && nw >= layout.feature + 1 ) ?
+          (float)v[ layout.feature ] : layout.defaultFeature;
+      i++;
+      p = e + 1;
+    }
+  }
+}
+
+//--- Values of the words of a line [line, end) ( at most maxValues ); returns their number
+int asciiPointParser::parseLine( const char* line, const char* end, double *values, int maxValues )
+{
+  int n = 0;
+  const char* p = line;
+  while( n < maxValues ) {
+    while( p < end && isSpace( *p ) )
+      p++;
+    if( p == end || *p == '\n' || *p == '\0' )
+      break;
+    const char* w = p;
+    while( p < end && !isSpace( *p ) && *p != '\n' && *p != '\0' )
+      p++;
+    values[n++] = parseWord( w, p );
+  }
+  return n;
+}
@@ -0,0 +1,69 @@
+#ifndef _asciiPointParser_H__
+#define _asciiPointParser_H__
+
+#include <vector>
+#include <cstddef>
+
+//--- Parser of text point data shared by the readers ( xyz, ply ascii, SPBR )
+//    The file is mapped into memory ( mmap ), line ends are found with memchr
+//    ( vectorized in the C library ), and the data region is split at line ends
+//    into chunks that are parsed in parallel. countPoints() counts the data lines
+//    of each chunk, so that parsePoints() writes every point directly into the
+//    arrays allocated by the reader ( one array per attribute ).
+//    Numbers are parsed without copying the words: a decimal whose mantissa is
+//    below 2^53 and whose exponent is small is converted exactly with one
+//    multiplication or division, other words are converted by strtod, so that
+//    the values are the same as atof().
+class asciiPointParser {
+
+ public:
+  //--- Columns of the attributes on a data line
+  //    A group ( x y z, nx ny nz, r g b ) is read when all its columns are on the line.
+  struct Layout
+  {
+    int coord;                      // First column of x, y, z
+    int normal;                     // First column of nx, ny, nz ( -1: not read )
+    int color;                      // First column of r, g, b ( -1: not read )
+    int feature;                    // Column of the feature value ( -1: not read )
+    int minWords;                   // Fewer words on a data line: error
+    float defaultNormal[3];
+    unsigned char defaultColor[3];
+    float defaultFeature;
+  };
+
+  //--- Arrays of the points ( NULL: not stored )
+  struct PointArrays
+  {
+    float *coords;                  // 3 per point
+    float *normals;                 // 3 per point
+    unsigned char *colors;          // 3 per point
+    float *features;                // 1 per point
+  };
+
+  static const size_t ALL_LINES = (size_t)-1;
+
+ public:
+  asciiPointParser( const char* filename );
+  ~asciiPointParser( void );
+
+  size_t lineAfter( const char* prefix );
+  size_t countPoints( size_t offset, size_t maxPoints = ALL_LINES );
+  void parsePoints( const Layout &layout, PointArrays &arrays );
+
+  static int parseLine( const char* line, const char* end, double *values, int maxValues );
+
+ private:
+  const char* lineEnd( const char* p, const char* end );
+  bool isDataLine( const char* p, const char* end );
+
+ private:
+  const char* m_filename;
+  const char* m_data;               // Mapped file ( or m_buffer )
+  size_t m_size;
+  bool m_isMapped;
+  std::vector<char> m_buffer;       // Contents of the file when mmap fails
+  std::vector<size_t> m_chunkBegin; // Byte offset of each chunk ( and the end )
+  std::vector<size_t> m_chunkFirst; // First point of each chunk ( and the total )
+};
+
+#endif
@@ -1,14 +1,19 @@
 #include "calculateFeature.h"
 #include "octree.h"
+#include "unionFind.h"
+#include "parallelSortKeys.h"
 
 #include <Accelerate/Accelerate.h> //CLAPACK
 
 #include <vector>
 #include <cmath>
 #include <fstream>
+#include <iomanip>
 #include <sstream>
+#include <algorithm>
+#include <atomic>
 
-#include <kvs/BoxMuller>
+#include <kvs/MersenneTwister>
 #include <kvs/Vector3>
 #include <kvs/Matrix33>
 #include <kvs/Matrix>
@@ -19,10 +24,148 @@ const double EPSILON = 1.0e-16;
 const int MIN_NODE   = 15;
 const int DIM        = 3;
 
+// Plane segmentation pre-pass
+const int MIN_PLANE_POINTS = 10;     // Minimum number of points in a planar cell
+const int MIN_REGION_CELLS = 9;      // Minimum number of cells in a large planar region
+const double PLANE_COS     = 0.995;  // Allowed angle between normals of neighboring cells ( about 5.7 deg )
+const int PLANE_KEY_BITS   = 21;     // Bits per axis of a cell key
+
+// Coarse-to-fine feature
+const int COARSE_KEY_BITS  = 21;     // Bits per axis of a voxel key
+
+// Automatic local-area radius
+const int SPACING_SAMPLES       = 1000;   // Number of sampled points
+const int SPACING_NEIGHBORS     = 8;      // k of the k-th nearest neighbor distance
+const double AUTO_NEIGHBORS     = 40.0;   // Points in the recommended local area
+const double AUTO_MIN_NEIGHBORS = 20.0;   // Points in the local area of the minimum radius
+const double AUTO_MAX_NEIGHBORS = 100.0;  // Points in the local area of the maximum radius
+
+// Incremental feature
+const double INCREMENTAL_RADIUS_TOLERANCE = 1.0e-6;   // Relative difference from the previous radius
+
+// User-defined feature expression
+const size_t EXPRESSION_BATCH = 4096;     // Points evaluated at once
+
+// --- Fused neighborhood kernels.
+//     The neighbors of a point are gathered once into a contiguous scratch buffer
+//     ( one array per axis, reused by each thread ), so that the mean, covariance and
+//     residual loops run with unit stride instead of gathering coords[3 * nearInd[j]].
+struct NeighborBuffer
+{
+  std::vector<double> x, y, z;
+};
+
+//--- Gather the neighbors ( 3 values per point ) and accumulate their mean in the same pass
+static void gatherNeighbors( const float *data, const std::vector<size_t> &nearInd,
+                             NeighborBuffer &buf, double mean[3] )
+{
+  size_t n0 = nearInd.size();
+  buf.x.resize( n0 );
+  buf.y.resize( n0 );
+  buf.z.resize( n0 );
+
+  double xb = 0.0, yb = 0.0, zb = 0.0;
+  for ( size_t j = 0; j < n0; j++ )
+  {
+    const float *p = data + 3 * nearInd[j];
+    buf.x[j] = p[0];
+    buf.y[j] = p[1];
+    buf.z[j] = p[2];
+    xb += p[0];
+    yb += p[1];
+    zb += p[2];
+  }
+  mean[0] = xb / (double)n0;
+  mean[1] = yb / (double)n0;
+  mean[2] = zb / (double)n0;
+}
+
+//--- Covariance matrix of the gathered points about the mean ( xx, yy, zz, xy, yz, zx )
+static void gatheredCovariance( const NeighborBuffer &buf, const double mean[3], double C[6] )
+{
+  size_t n0 = buf.x.size();
+  const double *px = buf.x.data();
+  const double *py = buf.y.data();
+  const double *pz = buf.z.data();
+
+  double xx = 0.0, yy = 0.0, zz = 0.0;
+  double xy = 0.0, yz = 0.0, zx = 0.0;
+  for ( size_t j = 0; j < n0; j++ )
+  {
+    double nx = px[j] - mean[0];
+    double ny = py[j] - mean[1];
+    double nz = pz[j] - mean[2];
+    xx += nx * nx;
+    yy += ny * ny;
+    zz += nz * nz;
+    xy += nx * ny;
+    yz += ny * nz;
+    zx += nz * nx;
+  }
+  C[0] = xx / (double)n0; C[1] = yy / (double)n0; C[2] = zz / (double)n0;
+  C[3] = xy / (double)n0; C[4] = yz / (double)n0; C[5] = zx / (double)n0;
+}
+
+//--- Eigenvalues W[0] <= W[1] <= W[2] ( LAPACK; eigenvectors in A with jobz = 'V' )
+static void covarianceEigen( const double C[6], char jobz, double A[], double W[] )
+{
+  char uplo = 'U';
+  int n     = DIM;
+  int lwork = DIM * DIM;
+  double WORK[DIM * DIM];
+  int info;
+
+  A[0] = C[0]; A[3] = C[3]; A[6] = C[5];
+  A[1] = 0.0 ; A[4] = C[1]; A[7] = C[4];
+  A[2] = 0.0 ; A[5] = 0.0 ; A[8] = C[2];
+
+  dsyev_( &jobz, &uplo, (__CLPK_integer *) &n, A, (__CLPK_integer *) &n,
+          W, WORK, (__CLPK_integer *) &lwork, (__CLPK_integer *) &info );
+}
+
+//--- Number of gathered points farther than tolerance from the plane through the mean
+static int gatheredPlaneOutliers( const NeighborBuffer &buf, const double mean[3],
+                                  const double normal[3], double tolerance )
+{
+  size_t n0 = buf.x.size();
+  const double *px = buf.x.data();
+  const double *py = buf.y.data();
+  const double *pz = buf.z.data();
+
+  int count = 0;
+  for ( size_t j = 0; j < n0; j++ )
+  {
+    double d = ( px[j] - mean[0] ) * normal[0] +
+               ( py[j] - mean[1] ) * normal[1] +
+               ( pz[j] - mean[2] ) * normal[2];
+    count += ( std::fabs( d ) > tolerance );
+  }
+  return count;
+}
+
 calculateFeature::calculateFeature( void ) : m_type( PointPCA ),
                                              m_isNoise( false ),
                                              m_noise( 0.0 ),
-                                             m_searchRadius( 0.01 )
+                                             m_searchRadius( 0.01 ),
+                                             m_isEstimateNormal( false ),
+                                             m_viewpoint( 0.0, 0.0, 0.0 ),
+                                             m_isPlaneSegmentation( false ),
+                                             m_isAutoRadius( false ),
+                                             m_pointSpacing( 0.0 ),
+                                             m_autoRadius( 0.0 ),
+                                             m_autoMinRadius( 0.0 ),
+                                             m_autoMaxRadius( 0.0 ),
+                                             m_expression( NULL ),
+                                             m_oldRadius( 0.0 ),
+                                             m_oldFeatureValueID( -1 ),
+                                             m_oldRawMax( 0.0 ),
+                                             m_isRegionOfInterest( false ),
+                                             m_isRoiBox( false ),
+                                             m_eigenCache( NULL ),
+                                             m_checkpoint( NULL ),
+                                             m_isFixedRadius( false ),
+                                             m_isNormalize( true ),
+                                             m_rawMaxFeature( 0.0 )
 {
 }
 
@@ -33,7 +176,26 @@ calculateFeature::calculateFeature( const FeatureType type,
                                                                 m_feature_id(id),
                                                                 m_isNoise(false),
                                                                 m_noise(0.0),
-                                                                m_searchRadius(distance)
+                                                                m_searchRadius(distance),
+                                                                m_isEstimateNormal(false),
+                                                                m_viewpoint(0.0, 0.0, 0.0),
+                                                                m_isPlaneSegmentation(false),
+                                                                m_isAutoRadius(false),
+                                                                m_pointSpacing(0.0),
+                                                                m_autoRadius(0.0),
+                                                                m_autoMinRadius(0.0),
+                                                                m_autoMaxRadius(0.0),
+                                                                m_expression(NULL),
+                                                                m_oldRadius(0.0),
+                                                                m_oldFeatureValueID(-1),
+                                                                m_oldRawMax(0.0),
+                                                                m_isRegionOfInterest(false),
+                                                                m_isRoiBox(false),
+                                                                m_eigenCache(NULL),
+                                                                m_checkpoint(NULL),
+                                                                m_isFixedRadius(false),
+                                                                m_isNormalize(true),
+                                                                m_rawMaxFeature(0.0)
 {
   calc( ply );
 }
@@ -55,6 +217,114 @@ void calculateFeature::addNoise( double noise )
   std::cout << "ADD NOISE : " << noise << std::endl;
 }
 
+// --- Output the eigenvector of the smallest eigenvalue as a normal vector.
+//     Normals are flipped to face the viewpoint.
+void calculateFeature::setNormalEstimation( bool flag, kvs::Vector3f viewpoint )
+{
+  m_isEstimateNormal = flag;
+  m_viewpoint        = viewpoint;
+}
+
+// --- Skip PCA for points inside large planar regions ( feature value 0 ).
+void calculateFeature::setPlaneSegmentation( bool flag )
+{
+  m_isPlaneSegmentation = flag;
+}
+
+// --- Local-area radius from the measured point spacing instead of the 1/local-area_radius prompt.
+void calculateFeature::setAutoSearchRadius( bool flag )
+{
+  m_isAutoRadius = flag;
+}
+
+// --- Compute features only at the given points ( against all the points as neighbors ).
+void calculateFeature::setPreviewPoints( const std::vector<size_t> &index )
+{
+  m_previewIndex = index;
+}
+
+// --- Feature value from a user-defined expression of the eigenvalues ( Point PCA ).
+void calculateFeature::setFeatureExpression( featureExpression *expression )
+{
+  m_expression = expression;
+}
+
+// --- Recompute only around appended points. The first oldFeature.size() points of the
+//     cloud given to calc() are the old points with the features of the previous run.
+//     oldRadius and oldFeatureValueID are the parameters of the previous run ( 0, -1: unknown ).
+void calculateFeature::setIncremental( const std::vector<float> &oldFeature,
+                                       double oldRadius, int oldFeatureValueID,
+                                       double oldRawMax )
+{
+  m_oldFeature = oldFeature;
+  m_oldRadius = oldRadius;
+  m_oldFeatureValueID = oldFeatureValueID;
+  m_oldRawMax = oldRawMax;
+}
+
+// --- Save the eigenvalues of each radius, and read them back in later runs.
+void calculateFeature::setEigenCache( eigenCache *cache )
+{
+  m_eigenCache = cache;
+}
+
+// --- Save the state after each completed radius ( minimum entropy ), and resume from it.
+void calculateFeature::setCheckpoint( featureCheckpoint *checkpoint )
+{
+  m_checkpoint = checkpoint;
+}
+
+// --- Use the radius given by setSearchRadius() without the prompt.
+void calculateFeature::setFixedSearchRadius( bool flag )
+{
+  m_isFixedRadius = flag;
+}
+
+// --- false: Point PCA features are not divided by their maximum ( see rawMaxFeature() ).
+void calculateFeature::setNormalization( bool flag )
+{
+  m_isNormalize = flag;
+}
+
+// --- Compute features only inside an axis-aligned box, or at the listed points.
+//     The output contains only the ROI points ( roiIndex() ).
+void calculateFeature::setRegionOfInterest( kvs::Vector3f roiMin, kvs::Vector3f roiMax )
+{
+  m_isRegionOfInterest = true;
+  m_isRoiBox = true;
+  m_roiMin   = roiMin;
+  m_roiMax   = roiMax;
+}
+
+void calculateFeature::setRegionOfInterest( const std::vector<size_t> &index )
+{
+  m_isRegionOfInterest = true;
+  m_isRoiBox = false;
+  m_roiIndex = index;
+}
+
+// --- Minimum and maximum local-area radii ( prompt, or the measured range with auto radius ).
+void calculateFeature::inputMinMaxSearchRadius( kvs::PolygonObject *ply, double &minRadius, double &maxRadius )
+{
+  if ( m_isAutoRadius )
+  {
+    minRadius = m_autoMinRadius;
+    maxRadius = m_autoMaxRadius;
+    return;
+  }
+
+  double min_highlight_precision_inv;
+  double max_highlight_precision_inv;
+
+  std::cout << "Input minimum 1/local-area_radius (recommend range [100-600]) >> ";
+  std::cin  >> min_highlight_precision_inv;
+  std::cout << "Input maximum 1/local-area_radius (recommend range [100-600]) >> ";
+  std::cin  >> max_highlight_precision_inv;
+
+  minRadius = setMinMaxSearchRadius( max_highlight_precision_inv, ply->minObjectCoord(), ply->maxObjectCoord() );
+  maxRadius = setMinMaxSearchRadius( min_highlight_precision_inv, ply->minObjectCoord(), ply->maxObjectCoord() );
+}
+
 void calculateFeature::setSearchRadius( double distance )
 {
   m_searchRadius = distance;
@@ -81,31 +351,80 @@ double calculateFeature::setMinMaxSearchRadius( double divide,
 
 void calculateFeature::calc( kvs::PolygonObject *ply )
 {
-  std::vector<float> normal;
-  kvs::BoxMuller normRand;
-
-  kvs::ValueArray<kvs::Real32> coords  = ply->coords();
   kvs::ValueArray<kvs::Real32> normals = ply->normals();
 
   size_t num = ply->numberOfVertices();
   m_number   = num;
-  double d_noise = sqrt( m_searchRadius ) * m_noise;
   bool hasNormal = false;
+  kvs::PolygonObject *crop = NULL;   // ROI and halo points ( region of interest )
+
+  if ( !m_previewIndex.empty() && m_type != PointPCA )
+  {
+    std::cout << "Preview is available only for Point PCA ( all the points are computed )" << std::endl;
+    m_previewIndex.clear();
+  }
+
+  if ( !m_oldFeature.empty() && ( m_type != PointPCA || m_expression != NULL || m_isPlaneSegmentation ) )
+  {
+    std::cout << "ERROR: Incremental mode is available only for Point PCA with a feature value ID" << std::endl;
+    exit( 1 );
+  }
+
+  if ( m_expression != NULL && m_type != PointPCA )
+  {
+    std::cout << "Feature expression is available only for Point PCA" << std::endl;
+    m_expression = NULL;
+  }
+
+  if ( m_checkpoint != NULL && m_type != MinimumEntropyFeature )
+  {
+    std::cout << "Checkpoint is available only for Minimum entropy PCA" << std::endl;
+    m_checkpoint = NULL;
+  }
+
+  if ( m_isAutoRadius && m_type != MeshDihedralFeature )
+    estimateSearchRadius( ply );
 
-  if ( m_type != MinimumEntropyFeature )
+  if ( m_type != MinimumEntropyFeature && m_type != MultiScaleFeature &&
+       m_type != AdaptiveRadiusFeature && m_type != MeshDihedralFeature )
   {
     double highlight_precision_inv;
 
     std::cout << "Highlighting precision" << std::endl;
-    std::cout << "Input 1/local-area_radius (recommend range [100-600]) >> ";
-    std::cin >> highlight_precision_inv;
+    if ( m_isAutoRadius )
+      setSearchRadius( m_autoRadius );
+    else if ( !m_isFixedRadius )
+    {
+      std::cout << "Input 1/local-area_radius (recommend range [100-600]) >> ";
+      std::cin >> highlight_precision_inv;
 
-    setSearchRadius( highlight_precision_inv, ply->minObjectCoord() , ply->maxObjectCoord() );
+      setSearchRadius( highlight_precision_inv, ply->minObjectCoord() , ply->maxObjectCoord() );
+    }
 
     std::cout << "Local-area radius = " << m_searchRadius << std::endl;
     std::cout << std::endl;
   }
 
+  //--- Region of interest: only the ROI points and their halo are used from here
+  if ( m_isRegionOfInterest )
+  {
+    if ( m_type == PointPCA && m_oldFeature.empty() )
+    {
+      if ( !m_previewIndex.empty() )
+        std::cout << "Preview is replaced by the region of interest" << std::endl;
+      crop = cropRegionOfInterest( ply );
+      ply      = crop;
+      normals  = ply->normals();
+      num      = ply->numberOfVertices();
+      m_number = num;
+    }
+    else
+    {
+      std::cout << "Region of interest is available only for Point PCA ( all the points are computed )" << std::endl;
+      m_isRegionOfInterest = false;
+    }
+  }
+
   if ( num == ply->numberOfNormals() )
     hasNormal = true;
   if ( !hasNormal )
@@ -117,53 +436,81 @@ void calculateFeature::calc( kvs::PolygonObject *ply )
     }
   }
 
-  for ( size_t i = 0; i < num; i++ )
+  if ( m_isEstimateNormal )
   {
-    float x  = coords[3 * i];
-    float y  = coords[3 * i + 1];
-    float z  = coords[3 * i + 2];
-    float nx = 0.0;
-    float ny = 0.0;
-    float nz = 0.0;
-    if ( hasNormal )
-    {
-      nx = normals[3 * i];
-      ny = normals[3 * i + 1];
-      nz = normals[3 * i + 2];
-    }
-    if ( m_isNoise )
+    if ( m_type == NormalPCA || m_type == NormalDispersion )
     {
-      double dt = normRand.rand( 0.0, d_noise * d_noise );
-      x += dt * nx;
-      y += dt * ny;
-      z += dt * nz;
+      std::cout << "Normal estimation is not available for this feature type" << std::endl;
+      m_isEstimateNormal = false;
     }
-    normal.push_back( nx );
-    normal.push_back( ny );
-    normal.push_back( nz );
+    else
+      m_normal.assign( 3 * num, 0.0f );
+  }
+
+  m_isPlaneInterior.clear();
+  if ( m_isPlaneSegmentation )
+  {
+    bool zeroOnPlane = ( m_feature_id == CHANGE_OF_CURVATURE_ID || m_feature_id == APLANARITY_ID ||
+                         m_feature_id == LINEARITY_ID );
+    if ( m_type == PlaneBasedFeature || ( m_type == PointPCA && zeroOnPlane && m_expression == NULL ) )
+      calcPlaneSegmentation( ply );
+    else
+      std::cout << "Plane segmentation is not available for this feature type" << std::endl;
   }
 
-  if ( m_type == PointPCA )
+  if ( m_type == PointPCA && !m_oldFeature.empty() )
+    calcIncrementalFeature( ply );
+  else if ( m_type == PointPCA )
     calcPointPCA( ply );
   else if ( m_type == NormalPCA )
-    calcNormalPCA( ply, normal );
+    calcNormalPCA( ply, normals.data() );
   else if ( m_type == NormalDispersion )
-    calcNormalDispersion( ply, normal );
+    calcNormalDispersion( ply, normals.data() );
   else if ( m_type == MinimumEntropyFeature )
     calcMinimumEntropyFeature( ply );
   else if ( m_type == PlaneBasedFeature )
     calcPlaneBasedFeature( ply );
+  else if ( m_type == MultiScaleFeature )
+    calcMultiScaleFeature( ply );
+  else if ( m_type == AdaptiveRadiusFeature )
+    calcAdaptiveRadiusFeature( ply );
+  else if ( m_type == CoarseToFineFeature )
+    calcCoarseToFineFeature( ply );
+  else if ( m_type == MeshDihedralFeature )
+    calcMeshDihedralFeature( ply );
+
+  delete crop;
 }
 
 
 
 void calculateFeature::calcPointPCA( kvs::PolygonObject *ply )
 {
-  m_feature = calcFeatureValues( ply, m_searchRadius );
+  //--- Features derived from the ( cached ) eigenvalues of all the points
+  if ( m_eigenCache != NULL && m_previewIndex.empty() && m_isPlaneInterior.empty() )
+  {
+    std::vector<double> eigenValues, neighbors;
+    calcEigenValues( ply, m_searchRadius, eigenValues,
+                     m_isEstimateNormal ? &m_normal : NULL, &neighbors );
+    calcFeatureFromEigenValues( eigenValues, neighbors, m_searchRadius, m_feature );
+    return;
+  }
+
+  calcFeatureValues( ply, m_searchRadius, m_feature );
+
+  //--- Normals of the preview points
+  if ( !m_previewIndex.empty() && m_isEstimateNormal )
+  {
+    std::vector<float> previewNormal( 3 * m_previewIndex.size() );
+    for ( size_t q = 0; q < m_previewIndex.size(); q++ )
+      for ( int k = 0; k < 3; k++ )
+        previewNormal[3 * q + k] = m_normal[3 * m_previewIndex[q] + k];
+    m_normal.swap( previewNormal );
+  }
 }
 
 void calculateFeature::calcNormalPCA( kvs::PolygonObject *ply,
-                                      std::vector<float> &normal )
+                                      const float *normal )
 {
   ply->updateMinMaxCoords();
   kvs::ValueArray<kvs::Real32> coords = ply->coords();
@@ -186,108 +533,77 @@ void calculateFeature::calcNormalPCA( kvs::PolygonObject *ply,
             << maxBB << std::endl;
   octree *myTree = new octree(pdata, numVert, mrange, MIN_NODE);
 
-  kvs::MersenneTwister uniRand;
   double sigMax = 0.0;
+  m_feature.resize( numVert );
 
   std::cout << "Start OCtree Search..... " << std::endl;
-  for (size_t i = 0; i < numVert; i++)
+#pragma omp parallel
   {
-    if (i == numVert)
-      --i;
-    double point[3] = {coords[3 * i],
-                       coords[3 * i + 1],
-                       coords[3 * i + 2]};
-
     vector<size_t> nearInd;
     vector<double> dist;
-    search_points(point, m_searchRadius, pdata, myTree->octreeRoot, &nearInd, &dist);
-    int n0 = (int)nearInd.size();
-
-    //--- Calculaton of covariance matrix
-    double xx = 0.0, yy = 0.0, zz = 0.0;
-    double xa = 0.0, ya = 0.0, za = 0.0;
-    double xy = 0.0, yz = 0.0, zx = 0.0;
-    for (int j = 0; j < n0; j++)
-    {
-      double nx = normal[3 * nearInd[j]];
-      double ny = normal[3 * nearInd[j] + 1];
-      double nz = normal[3 * nearInd[j] + 2];
-      xx += nx * nx;
-      yy += ny * ny;
-      zz += nz * nz;
-      xa += nx;
-      ya += ny;
-      za += nz;
-      xy += nx * ny;
-      yz += ny * nz;
-      zx += nz * nx;
-    }
-    double s_xx = (xx - xa * xa / (double)n0) / (double)n0;
-    double s_yy = (yy - ya * ya / (double)n0) / (double)n0;
-    double s_zz = (zz - za * za / (double)n0) / (double)n0;
-    double s_xy = (xy - xa * ya / (double)n0) / (double)n0;
-    double s_yz = (yz - ya * za / (double)n0) / (double)n0;
-    double s_zx = (zx - za * xa / (double)n0) / (double)n0;
-
-    //---- Covariance matrix
-    kvs::Matrix<double> M( 3, 3 );
-    M[0][0] = s_xx; M[0][1] = s_xy; M[0][2] = s_zx;
-    M[1][0] = s_xy; M[1][1] = s_yy; M[1][2] = s_yz;
-    M[2][0] = s_zx; M[2][1] = s_yz; M[2][2] = s_zz;
-
-    //---- Calcuation of eigenvalues
-    // kvs::EigenDecomposer<double> eigen( M );
-
-    // const kvs::Vector<double>& L = eigen.eigenValues();
-
-    // L[0]: 第1固有値, L[1]: 第2固有値, L[2]: 第3固有値
-    // double sum = L[0] + L[1] + L[2]; // Sum of eigenvalues
-    // double var = searchPoint.x;
-    // double var = L[2] / sum; // Change of curvature
-    // double var = (L[0] - L[1]) / L[0]; // Linearity
-    // double var = L[1] - L[2] / L[0];             // Planarity
-    // double var = 1 - ( ( L[1] - L[2] ) / L[0] ); // Aplanarity
-    // double var = L[0];
-
-    // Caluculate Covariance matrix and EigenVectors using LAPACK
-    //--- Preparation for LAPACK
-    char jovz = 'V';
-    char uplo = 'U';
-    int n     = DIM;
-    double A[n*n];
-    double W[n];
-    int lwork = n*n;
-    double WORK[n*n];
-    int info;
-
-    //---- Covariance matrix
-    A[0] = s_xx; A[3] = s_xy; A[6] = s_zx;
-    A[1] = 0.0 ; A[4] = s_yy; A[7] = s_yz;
-    A[2] = 0.0 ; A[5] = 0.0 ; A[8] = s_zz;
-
-    //---- Calcuation of eigenvalues and egenvectors
-    dsyev_( &jovz, &uplo, (__CLPK_integer *) &n, A, (__CLPK_integer *) &n,
-            W, WORK, (__CLPK_integer *) &lwork, (__CLPK_integer *) &info );
-
-    // W[2]: 第1固有値, W[1]: 第2固有値, W[0]: 第3固有値
-    // Sum of eigenvalues
-    double sum = W[2] + W[1] + W[0];
-
-    // Change of curvature
-    double var = W[0] / sum;
-
-    m_feature.push_back(var);
-    if (sigMax < var)
-      sigMax = var;
-    if (!((i + 1) % INTERVAL))
-      std::cout << i + 1 << ", " << n0 << ": " << var << std::endl;
+    NeighborBuffer buf;
+
+#pragma omp for schedule(dynamic, 256) reduction(max:sigMax)
+    for ( long i = 0; i < (long)numVert; i++ )
+    {
+      double point[3] = {coords[3 * i],
+                         coords[3 * i + 1],
+                         coords[3 * i + 2]};
+
+      nearInd.clear();
+      dist.clear();
+      search_points(point, m_searchRadius, pdata, myTree->octreeRoot, &nearInd, &dist);
+      int n0 = (int)nearInd.size();
+
+      //--- Covariance matrix of the neighbor normals
+      double mean[3];
+      double C[6];
+      gatherNeighbors( normal, nearInd, buf, mean );
+      gatheredCovariance( buf, mean, C );
+
+      // Caluculate Covariance matrix and Eigenvalues using LAPACK
+      //--- Preparation for LAPACK
+      char jovz = 'N';
+      char uplo = 'U';
+      int n     = DIM;
+      double A[DIM*DIM];
+      double W[DIM];
+      int lwork = DIM*DIM;
+      double WORK[DIM*DIM];
+      int info;
+
+      //---- Covariance matrix
+      A[0] = C[0]; A[3] = C[3]; A[6] = C[5];
+      A[1] = 0.0 ; A[4] = C[1]; A[7] = C[4];
+      A[2] = 0.0 ; A[5] = 0.0 ; A[8] = C[2];
+
+      //---- Calcuation of eigenvalues
+      dsyev_( &jovz, &uplo, (__CLPK_integer *) &n, A, (__CLPK_integer *) &n,
+              W, WORK, (__CLPK_integer *) &lwork, (__CLPK_integer *) &info );
+
+      // W[2]: 第1固有値, W[1]: 第2固有値, W[0]: 第3固有値
+      // Sum of eigenvalues
+      double sum = W[2] + W[1] + W[0];
+
+      // Change of curvature
+      double var = W[0] / sum;
+
+      m_feature[i] = var;
+      if (sigMax < var)
+        sigMax = var;
+      if (!((i + 1) % INTERVAL))
+        std::cout << i + 1 << ", " << n0 << ": " << var << std::endl;
+    }
   }
+  delete myTree;
+  delete [] mrange;
+
   m_maxFeature = sigMax;
   std::cout << "Maximun of Sigma : " << sigMax << std::endl;
 }
 
 void calculateFeature::calcNormalDispersion( kvs::PolygonObject *ply,
-                                             std::vector<float> &normal )
+                                             const float *normal )
 {
   ply->updateMinMaxCoords();
   kvs::ValueArray<kvs::Real32> coords = ply->coords();
@@ -310,47 +626,58 @@ void calculateFeature::calcNormalDispersion( kvs::PolygonObject *ply,
             << maxBB << std::endl;
   octree *myTree = new octree(pdata, numVert, mrange, MIN_NODE);
 
-  kvs::MersenneTwister uniRand;
   double sigMax = 0.0;
+  m_feature.resize( numVert );
 
   std::cout << "Start OCtree Search..... " << std::endl;
-
-  for (size_t i = 0; i < numVert; i++)
+#pragma omp parallel
   {
-    if (i == numVert)
-      --i;
-    double point[3] = {coords[3 * i],
-                       coords[3 * i + 1],
-                       coords[3 * i + 2]};
-
     vector<size_t> nearInd;
     vector<double> dist;
-    search_points(point, m_searchRadius, pdata, myTree->octreeRoot, &nearInd, &dist);
-    int n0 = (int)nearInd.size();
+    NeighborBuffer buf;
 
-    int index = nearInd[0];
-    float ni[3] = {normal[3 * index], normal[3 * index + 1], normal[3 * index + 2]};
-
-    double sum = 0.0;
-    double sum2 = 0.0;
-    for (int j = 1; j < n0; j++)
+#pragma omp for schedule(dynamic, 256) reduction(max:sigMax)
+    for ( long i = 0; i < (long)numVert; i++ )
     {
-      index = nearInd[j];
-      float nt[3] = {normal[3 * index], normal[3 * index + 1], normal[3 * index + 2]};
-      double dot = ni[0] * nt[0] + ni[1] * nt[1] + ni[2] * nt[2];
-      sum += dot;
-      sum2 += dot * dot;
-    }
+      double point[3] = {coords[3 * i],
+                         coords[3 * i + 1],
+                         coords[3 * i + 2]};
+
+      nearInd.clear();
+      dist.clear();
+      search_points(point, m_searchRadius, pdata, myTree->octreeRoot, &nearInd, &dist);
+      int n0 = (int)nearInd.size();
+
+      //--- Dot products between the normal of the point ( nearInd[0] ) and the neighbor normals
+      double mean[3];
+      gatherNeighbors( normal, nearInd, buf, mean );
+      const double *nx = buf.x.data();
+      const double *ny = buf.y.data();
+      const double *nz = buf.z.data();
+      float ni[3] = {(float)nx[0], (float)ny[0], (float)nz[0]};
+
+      double sum = 0.0;
+      double sum2 = 0.0;
+      for (int j = 1; j < n0; j++)
+      {
+        double dot = ni[0] * (float)nx[j] + ni[1] * (float)ny[j] + ni[2] * (float)nz[j];
+        sum += dot;
+        sum2 += dot * dot;
+      }
 
-    double mean = sum / (double)(n0 - 1);
-    double var = (sum2 - (double)(n0 - 1) * mean * mean) / (double)(n0 - 1);
+      double mean_dot = sum / (double)(n0 - 1);
+      double var = (sum2 - (double)(n0 - 1) * mean_dot * mean_dot) / (double)(n0 - 1);
 
-    m_feature.push_back(var); //
-    if (sigMax < var)
-      sigMax = var;
-    if (!((i + 1) % INTERVAL))
-      std::cout << i + 1 << ", " << n0 << ": " << var << std::endl;
+      m_feature[i] = var;
+      if (sigMax < var)
+        sigMax = var;
+      if (!((i + 1) % INTERVAL))
+        std::cout << i + 1 << ", " << n0 << ": " << var << std::endl;
+    }
   }
+  delete myTree;
+  delete [] mrange;
+
   m_maxFeature = sigMax;
   std::cout << "Maximun of Sigma : " << sigMax << std::endl;
 }
@@ -362,45 +689,58 @@ void calculateFeature::calcMinimumEntropyFeature( kvs::PolygonObject *ply )
 
   std::vector<double> eigenValues;
 
-  std::vector<float> tmpEigentropy;
-  std::vector<float> selectedFeature;
-
   size_t numVert = ply->numberOfVertices();
 
   float sigMax = 0.0;
 
-  double min_highlight_precision_inv;
-  double max_highlight_precision_inv;
   int number_of_calculations;
+  double min_local_area_radius, max_local_area_radius;
 
   std::cout << "Highlighting precision" << std::endl;
-  std::cout << "Input minimum 1/local-area_radius (recommend range [100-600]) >> ";
-  std::cin  >> min_highlight_precision_inv;
-  std::cout << "Input maximum 1/local-area_radius (recommend range [100-600]) >> ";
-  std::cin  >> max_highlight_precision_inv;
+  inputMinMaxSearchRadius( ply, min_local_area_radius, max_local_area_radius );
   std::cout << "Input Number of calculations >> ";
   std::cin  >> number_of_calculations;
 
-  double min_local_area_radius = setMinMaxSearchRadius( max_highlight_precision_inv, ply->minObjectCoord(), ply->maxObjectCoord() );
-  double max_local_area_radius = setMinMaxSearchRadius( min_highlight_precision_inv, ply->minObjectCoord(), ply->maxObjectCoord() );
-
   std::cout << "Minimum local-area radius = " << min_local_area_radius << std::endl;
   std::cout << "Maximum local-area radius = " << max_local_area_radius << std::endl;
   std::cout << std::endl;
 
-  std::vector<vector<float>> eigentropy( number_of_calculations, vector<float>(numVert) );
-  std::vector<vector<float>> featureValues( number_of_calculations, vector<float>(numVert) );
+  //--- Running selection over the radii: minimum eigentropy so far and its feature ( and normal )
+  std::vector<float> minEigentropy( numVert, 0.0f );
+  std::vector<float> selectedFeature( numVert, 0.0f );
+  std::vector<float> normal;
+
+  //--- Resume from the last completed radius
+  int firstCalculation = 0;
+  std::vector< std::vector<float>* > state;
+  state.push_back( &minEigentropy );
+  state.push_back( &selectedFeature );
+  state.push_back( &m_normal );
+  if ( m_checkpoint != NULL )
+  {
+    std::ostringstream key;
+    key.precision( 17 );
+    key << "MinimumEntropy " << numVert << " " << m_feature_id << " "
+        << min_local_area_radius << " " << max_local_area_radius << " "
+        << number_of_calculations << " " << m_isEstimateNormal << " "
+        << coordinateHash( ply->coords().data(), numVert );
+    m_checkpoint->setKey( key.str() );
+    if ( m_checkpoint->read( firstCalculation, state ) )
+      std::cout << "Resume from calculation " << firstCalculation + 1 << std::endl;
+  }
 
-  for ( int j = 0; j < number_of_calculations; j++ )
+  for ( int j = firstCalculation; j < number_of_calculations; j++ )
   {
     double itr_local_area_radius = min_local_area_radius + ( j * ( max_local_area_radius - min_local_area_radius ) / (double)( number_of_calculations-1.0 ) );
 
     std::cout << "Start calculation " << j+1 << std::endl;
     std::cout << "Local-area radius = " << itr_local_area_radius << std::endl;
 
-    eigenValues = calcEigenValues( ply, itr_local_area_radius );
+    calcEigenValues( ply, itr_local_area_radius, eigenValues,
+                     m_isEstimateNormal ? &normal : NULL );
 
-    for ( size_t i = 0; i < numVert; i++ )
+#pragma omp parallel for
+    for ( long i = 0; i < (long)numVert; i++ )
     {
       double sum = eigenValues[i*3] + eigenValues[i*3 + 1] + eigenValues[i*3 + 2];
       double ft;
@@ -427,45 +767,42 @@ void calculateFeature::calcMinimumEntropyFeature( kvs::PolygonObject *ply )
       if ( isnan(et) )
         et = 0.0;
 
-      featureValues[j][i] = ft;
-      eigentropy[j][i]    = et;
+      //--- Radius of the minimum eigentropy ( first one on ties )
+      if ( j == 0 || (float)et < minEigentropy[i] )
+      {
+        minEigentropy[i]   = et;
+        selectedFeature[i] = ft;
+        if ( m_isEstimateNormal )
+        {
+          m_normal[3 * i]     = normal[3 * i];
+          m_normal[3 * i + 1] = normal[3 * i + 1];
+          m_normal[3 * i + 2] = normal[3 * i + 2];
+        }
+      }
 
       if (!((i + 1) % INTERVAL))
         std::cout << i + 1 << ", " << "Feature Value: "  << ft  << ", " << "Eigentropy: " << et << std::endl;
 
     }
-    eigenValues.clear();
+
+    if ( m_checkpoint != NULL && j + 1 < number_of_calculations )
+      m_checkpoint->write( j + 1, state );
   }
 
   for ( size_t i = 0; i < numVert; i++ )
-  {
-    for ( int j = 0; j < number_of_calculations; j++ )
-    {
-      tmpEigentropy.push_back( eigentropy[j][i] );
-    }
-
-    std::vector<float>::iterator minIt = std::min_element( tmpEigentropy.begin(), tmpEigentropy.end() );
-    size_t minEigentropyIndex          = std::distance( tmpEigentropy.begin(), minIt );
-
-    tmpEigentropy.clear();
-
-    selectedFeature.push_back( featureValues[minEigentropyIndex][i] );
-
-    if ( sigMax < featureValues[minEigentropyIndex][i] )
-      sigMax = featureValues[minEigentropyIndex][i];
-  }
+    if ( sigMax < selectedFeature[i] )
+      sigMax = selectedFeature[i];
 
   m_maxFeature = 1.0;
   std::cout << "Maximun of Sigma : " << sigMax << std::endl;
 
-  // Normalize feature values
-  float normFt;
+  // Normalize feature values ( in place )
+  for ( size_t i = 0; i < numVert; i++ )
+    selectedFeature[i] = selectedFeature[i] / sigMax;
+  m_feature.swap( selectedFeature );
 
-  for ( float f : selectedFeature )
-  {
-    normFt = f / sigMax;
-    m_feature.push_back( normFt );
-  }
+  if ( m_checkpoint != NULL )
+    m_checkpoint->remove();
 }
 
 
@@ -497,153 +834,118 @@ void calculateFeature::calcPlaneBasedFeature( kvs::PolygonObject *ply )
             << maxBB << std::endl;
   octree *myTree = new octree(pdata, numVert, mrange, MIN_NODE);
 
-  kvs::MersenneTwister uniRand;
   double sigMax = 0.0;
-  std::vector<float> featureValues;
+  std::vector<float> featureValues( numVert, 0.0f );
 
   std::cout << "Start OCtree Search..... " << std::endl;
-  for (size_t i = 0; i < numVert; i++)
+#pragma omp parallel
   {
-    if (i == numVert)
-      --i;
-    double point[3] = {coords[3 * i],
-                       coords[3 * i + 1],
-                       coords[3 * i + 2]};
-
     vector<size_t> nearInd;
     vector<double> dist;
-    search_points(point, m_searchRadius, pdata, myTree->octreeRoot, &nearInd, &dist);
-    int n0 = (int)nearInd.size();
-
-    //--- Standardization for x, y, z
-    double xb = 0.0, yb = 0.0, zb = 0.0;
-    for (int j = 0; j < n0; j++)
-    {
+    NeighborBuffer buf;
 
-      double x = coords[3 * nearInd[j]];
-      double y = coords[3 * nearInd[j] + 1];
-      double z = coords[3 * nearInd[j] + 2];
-
-      xb += x;
-      yb += y;
-      zb += z;
-    }
-
-    xb /= (double)n0;
-    yb /= (double)n0;
-    zb /= (double)n0;
-
-    //--- Calculaton of covariance matrix
-    double xx = 0.0, yy = 0.0, zz = 0.0;
-    double xy = 0.0, yz = 0.0, zx = 0.0;
-    for (int j = 0; j < n0; j++)
+#pragma omp for schedule(dynamic, 256) reduction(max:sigMax)
+    for ( long i = 0; i < (long)numVert; i++ )
     {
-
-      double nx = (coords[3 * nearInd[j]] - xb);
-      double ny = (coords[3 * nearInd[j] + 1] - yb);
-      double nz = (coords[3 * nearInd[j] + 2] - zb);
-      xx += nx * nx;
-      yy += ny * ny;
-      zz += nz * nz;
-      xy += nx * ny;
-      yz += ny * nz;
-      zx += nz * nx;
+      if ( !m_isPlaneInterior.empty() && m_isPlaneInterior[i] )
+        continue;
+      double point[3] = {coords[3 * i],
+                         coords[3 * i + 1],
+                         coords[3 * i + 2]};
+
+      nearInd.clear();
+      dist.clear();
+      search_points(point, m_searchRadius, pdata, myTree->octreeRoot, &nearInd, &dist);
+      int n0 = (int)nearInd.size();
+
+      //--- Mean and covariance matrix of the gathered neighbors
+      double mean[3];
+      double C[6];
+      gatherNeighbors( pdata, nearInd, buf, mean );
+      gatheredCovariance( buf, mean, C );
+
+      // Caluculate Covariance matrix and EigenVectors using LAPACK
+      //--- Preparation for LAPACK
+      char jovz = 'V';
+      char uplo = 'U';
+      int n     = DIM;
+      double A[DIM*DIM];
+      double W[DIM];
+      int lwork = DIM*DIM;
+      double WORK[DIM*DIM];
+      int info;
+
+      //---- Covariance matrix
+      A[0] = C[0]; A[3] = C[3]; A[6] = C[5];
+      A[1] = 0.0 ; A[4] = C[1]; A[7] = C[4];
+      A[2] = 0.0 ; A[5] = 0.0 ; A[8] = C[2];
+
+      //---- Calcuation of eigenvalues and egenvectors
+      dsyev_( &jovz, &uplo, (__CLPK_integer *) &n, A, (__CLPK_integer *) &n,
+              W, WORK, (__CLPK_integer *) &lwork, (__CLPK_integer *) &info );
+
+      if ( m_isEstimateNormal )
+        storeNormal( m_normal, i, point, A, W[0] + W[1] + W[2] );
+
+      //--- Neighbors off the least squares plane
+      int notOnLocalPlane = gatheredPlaneOutliers( buf, mean, A, allowableError );
+
+      double var = (double)notOnLocalPlane/(double)n0;
+
+      featureValues[i] = var;
+
+      if (sigMax < var)
+        sigMax = var;
+      if (!((i + 1) % INTERVAL))
+        std::cout << i + 1 << ", " << n0 << ": " << var << std::endl;
     }
+  }
+  delete myTree;
+  delete [] mrange;
 
-    double s_xx = xx / (double)(n0);
-    double s_yy = yy / (double)(n0);
-    double s_zz = zz / (double)(n0);
-    double s_xy = xy / (double)(n0);
-    double s_yz = yz / (double)(n0);
-    double s_zx = zx / (double)(n0);
-
-    // double s_yx = s_xy;
-    // double s_zy = s_yz;
-    // double s_xz = s_zx;
-
-     /***
-
-    // Caluculate Covariance matrix and EigenVectors using KVS
-    //---- Covariance matrix
-    kvs::Matrix<double> M( 3, 3 );
-    M[0][0] = s_xx; M[0][1] = s_xy; M[0][2] = s_xz;
-    M[1][0] = s_yx; M[1][1] = s_yy; M[1][2] = s_yz;
-    M[2][0] = s_zx; M[2][1] = s_zy; M[2][2] = s_zz;
-
-    //---- Calcuation of eigenvalues
-    kvs::EigenDecomposer<double> eigen( M );
-    const kvs::Matrix<double>& E = eigen.eigenVectors();
-
-    ***/
-
-     // Caluculate Covariance matrix and EigenVectors using LAPACK
-    //--- Preparation for LAPACK
-    char jovz = 'V';
-    char uplo = 'U';
-    int n     = DIM;
-    double A[n*n];
-    double W[n];
-    int lwork = n*n;
-    double WORK[n*n];
-    int info;
-
-    //---- Covariance matrix
-    A[0] = s_xx; A[3] = s_xy; A[6] = s_zx;
-    A[1] = 0.0 ; A[4] = s_yy; A[7] = s_yz;
-    A[2] = 0.0 ; A[5] = 0.0 ; A[8] = s_zz;
-
-    //---- Calcuation of eigenvalues and egenvectors
-    dsyev_( &jovz, &uplo, (__CLPK_integer *) &n, A, (__CLPK_integer *) &n,
-            W, WORK, (__CLPK_integer *) &lwork, (__CLPK_integer *) &info );
-
-    int notOnLocalPlane = 0;
-
-    for ( int j = 0; j < n0; j++ )
-    {
-
-      // Calculate Local Plane
-      // double px = coords[3 * nearInd[j]]     - point[0];
-      // double py = coords[3 * nearInd[j] + 1] - point[1];
-      // double pz = coords[3 * nearInd[j] + 2] - point[2];
-
-      // Calculate Least Squares Plane
-      double px = coords[3 * nearInd[j]]     - xb;
-      double py = coords[3 * nearInd[j] + 1] - yb;
-      double pz = coords[3 * nearInd[j] + 2] - zb;
-
-      double localPlane = std::fabs( px*A[0] + py*A[1] + pz*A[2] );
+  m_maxFeature = 1.0;
+  std::cout << "Maximun of Sigma : " << sigMax << std::endl;
 
-      if ( localPlane > allowableError )
-        notOnLocalPlane++;
+  // Normalize feature values ( in place )
+  for ( size_t i = 0; i < numVert; i++ )
+    featureValues[i] = featureValues[i] / sigMax;
+  m_feature.swap( featureValues );
 
-    }
+}
 
-    double var = (double)notOnLocalPlane/(double)n0;
+// --- Calculate feature values at several radii with one octree search per point.
+//     Neighbors are searched once at the largest radius and their moments are
+//     binned by the smallest radius that contains them, so that the covariance
+//     matrix of every scale is obtained by a prefix sum over the bins.
+void calculateFeature::calcMultiScaleFeature( kvs::PolygonObject *ply )
+{
+  int number_of_scales;
+  double min_local_area_radius, max_local_area_radius;
 
-    featureValues.push_back(var);
+  std::cout << "Highlighting precision" << std::endl;
+  inputMinMaxSearchRadius( ply, min_local_area_radius, max_local_area_radius );
+  std::cout << "Input Number of scales >> ";
+  std::cin  >> number_of_scales;
 
-    if (sigMax < var)
-      sigMax = var;
-    if (!((i + 1) % INTERVAL))
-      std::cout << i + 1 << ", " << n0 << ": " << var << std::endl;
+  if ( number_of_scales < 1 )
+  {
+    std::cout << "Number of scales must be positive" << std::endl;
+    exit( 1 );
   }
 
-  m_maxFeature = 1.0;
-  std::cout << "Maximun of Sigma : " << sigMax << std::endl;
-
-  // Normalize feature values
-  float normFt;
-
-  for ( float f : featureValues )
+  const int K = number_of_scales;
+  m_scaleRadii.clear();
+  for ( int k = 0; k < K; k++ )
   {
-    normFt = f / sigMax;
-    m_feature.push_back( normFt );
+    double r = max_local_area_radius;
+    if ( K > 1 )
+      r = min_local_area_radius + ( k * ( max_local_area_radius - min_local_area_radius ) / (double)( K - 1.0 ) );
+    m_scaleRadii.push_back( r );
   }
-
-}
-
-std::vector<float> calculateFeature::calcFeatureValues( kvs::PolygonObject* ply, double radius )
-{
+  std::sort( m_scaleRadii.begin(), m_scaleRadii.end() );
+  for ( int k = 0; k < K; k++ )
+    std::cout << "Local-area radius " << k + 1 << " = " << m_scaleRadii[k] << std::endl;
+  std::cout << std::endl;
 
   ply->updateMinMaxCoords();
   kvs::ValueArray<kvs::Real32> coords = ply->coords();
@@ -666,166 +968,156 @@ std::vector<float> calculateFeature::calcFeatureValues( kvs::PolygonObject* ply,
             << maxBB << std::endl;
   octree *myTree = new octree( pdata, numVert, mrange, MIN_NODE );
 
-  kvs::MersenneTwister uniRand;
-
-  std::vector<float> featureValues;
-  double sigMax = 0.0;
+  // Moments of each bin: n, x, y, z, xx, yy, zz, xy, yz, zx
+  const int NUM_MOMENTS = 10;
+  std::vector<double> sigMax( K, 0.0 );
+  m_multiScaleFeature.assign( numVert * K, 0.0f );
 
   std::cout << "Start OCtree Search..... " << std::endl;
-  for ( size_t i = 0; i < numVert; i++ )
+#pragma omp parallel
   {
-    if ( i == numVert )
-      --i;
-    double point[3] = { coords[3 * i],
-                        coords[3 * i + 1],
-                        coords[3 * i + 2] };
-
     vector<size_t> nearInd;
     vector<double> dist;
-    search_points( point, radius, pdata, myTree->octreeRoot, &nearInd, &dist );
-    int n0 = (int)nearInd.size();
-
-    //--- Standardization for x, y, z
-    double xb = 0.0, yb = 0.0, zb = 0.0;
-    for ( int j = 0; j < n0; j++ )
-    {
-
-      double x = coords[3 * nearInd[j]];
-      double y = coords[3 * nearInd[j] + 1];
-      double z = coords[3 * nearInd[j] + 2];
-
-      xb += x;
-      yb += y;
-      zb += z;
-    }
-
-    xb /= (double)n0;
-    yb /= (double)n0;
-    zb /= (double)n0;
-
-    //--- Calculaton of covariance matrix
-    double xx = 0.0, yy = 0.0, zz = 0.0;
-    double xy = 0.0, yz = 0.0, zx = 0.0;
-    for (int j = 0; j < n0; j++)
-    {
-
-      double nx = ( coords[3 * nearInd[j]] - xb );
-      double ny = ( coords[3 * nearInd[j] + 1] - yb );
-      double nz = ( coords[3 * nearInd[j] + 2] - zb );
-      xx += nx * nx;
-      yy += ny * ny;
-      zz += nz * nz;
-      xy += nx * ny;
-      yz += ny * nz;
-      zx += nz * nx;
-    }
-
-    double s_xx = xx / (double)(n0);
-    double s_yy = yy / (double)(n0);
-    double s_zz = zz / (double)(n0);
-    double s_xy = xy / (double)(n0);
-    double s_yz = yz / (double)(n0);
-    double s_zx = zx / (double)(n0);
-
-    // double s_yx = s_xy;
-    // double s_zy = s_yz;
-    // double s_xz = s_zx;
-
-    /***
-
-    // Caluculate Covariance matrix and EigenValues using KVS
-    //---- Covariance matrix
-    kvs::Matrix<double> M( 3, 3 );
-    M[0][0] = s_xx; M[0][1] = s_xy; M[0][2] = s_xz;
-    M[1][0] = s_yx; M[1][1] = s_yy; M[1][2] = s_yz;
-    M[2][0] = s_zx; M[2][1] = s_zy; M[2][2] = s_zz;
-
-    //---- Calcuation of eigenvalues
-    kvs::EigenDecomposer<double> eigen( M );
-    const kvs::Vector<double>& L = eigen.eigenValues();
-
-    ***/
-
-    // Caluculate Covariance matrix and EigenValues using LAPACK
-    //--- Preparation for LAPACK
-    char jovz = 'V';
-    char uplo = 'U';
-    int n     = DIM;
-    double A[n*n];
-    double W[n];
-    int lwork = n*n;
-    double WORK[n*n];
-    int info;
-
-    //---- Covariance matrix
-    A[0] = s_xx; A[3] = s_xy; A[6] = s_zx;
-    A[1] = 0.0 ; A[4] = s_yy; A[7] = s_yz;
-    A[2] = 0.0 ; A[5] = 0.0 ; A[8] = s_zz;
-
-    //---- Calcuation of eigenvalues and egenvectors
-    dsyev_( &jovz, &uplo, (__CLPK_integer *) &n, A, (__CLPK_integer *) &n,
-            W, WORK, (__CLPK_integer *) &lwork, (__CLPK_integer *) &info );
-
-
-    // W[2]: 第1固有値, W[1]: 第2固有値, W[0]: 第3固有値
-    // Sum of eigenvalues
-    double sum = W[2] + W[1] + W[0];
-    double var;
-
-    if ( m_feature_id == CHANGE_OF_CURVATURE_ID )
-      var = W[0] / sum;
-    else if ( m_feature_id == APLANARITY_ID )
-      var = 1 - ( (W[1] - W[0]) / W[2] );
-    else if ( m_feature_id == LINEARITY_ID )
-      var = ( W[2] - W[1] ) / W[2];
-    else if ( m_feature_id == EIGENTROPY_ID )
-    {
-      double lambda1 = W[2] / sum;
-      double lambda2 = W[1] / sum;
-      double lambda3 = W[0] / sum;
-      var = -( lambda1 * log(lambda1) + lambda2 * log(lambda2) + lambda3 * log(lambda3) );
-
-      if (isnan(var))
-        var = 0.0;
-    }
+    std::vector<double> moments( K * NUM_MOMENTS );
+    std::vector<double> localMax( K, 0.0 );
 
-    // Planarity
-    // double var = ( W[1] - W[0]) / W[2];
+#pragma omp for schedule(dynamic, 256)
+    for ( long i = 0; i < (long)numVert; i++ )
+    {
+      double point[3] = { coords[3 * i],
+                          coords[3 * i + 1],
+                          coords[3 * i + 2] };
+
+      nearInd.clear();
+      dist.clear();
+      search_points( point, m_scaleRadii[K - 1], pdata, myTree->octreeRoot, &nearInd, &dist );
+      int n0 = (int)nearInd.size();
+
+      //--- Binning by the smallest radius including the neighbor
+      std::fill( moments.begin(), moments.end(), 0.0 );
+      for ( int j = 0; j < n0; j++ )
+      {
+        int k = 0;
+        while ( k < K - 1 && dist[j] >= m_scaleRadii[k] )
+          k++;
+
+        // Coordinates relative to the query point
+        double x = coords[3 * nearInd[j]]     - point[0];
+        double y = coords[3 * nearInd[j] + 1] - point[1];
+        double z = coords[3 * nearInd[j] + 2] - point[2];
+
+        double *m = &moments[k * NUM_MOMENTS];
+        m[0] += 1.0;
+        m[1] += x;     m[2] += y;     m[3] += z;
+        m[4] += x * x; m[5] += y * y; m[6] += z * z;
+        m[7] += x * y; m[8] += y * z; m[9] += z * x;
+      }
 
-    // double var = W[0];
-    // double var = coords[3 * i];
+      for ( int k = 0; k < K; k++ )
+      {
+        double *m = &moments[k * NUM_MOMENTS];
+
+        //--- Accumulate the bins of the smaller radii
+        if ( k > 0 )
+          for ( int l = 0; l < NUM_MOMENTS; l++ )
+            m[l] += m[l - NUM_MOMENTS];
+
+        double nk = m[0];
+        if ( nk < 1.0 )
+          continue;
+
+        double xb = m[1] / nk, yb = m[2] / nk, zb = m[3] / nk;
+
+        // Caluculate EigenValues using LAPACK
+        // ( eigenvectors only for the normal at the largest radius )
+        bool isLargest = ( k == K - 1 );
+        char jovz = ( m_isEstimateNormal && isLargest ) ? 'V' : 'N';
+        char uplo = 'U';
+        int n     = DIM;
+        double A[n*n];
+        double W[n];
+        int lwork = n*n;
+        double WORK[n*n];
+        int info;
+
+        //---- Covariance matrix
+        A[0] = m[4] / nk - xb * xb; A[3] = m[7] / nk - xb * yb; A[6] = m[9] / nk - zb * xb;
+        A[1] = 0.0                ; A[4] = m[5] / nk - yb * yb; A[7] = m[8] / nk - yb * zb;
+        A[2] = 0.0                ; A[5] = 0.0                ; A[8] = m[6] / nk - zb * zb;
+
+        //---- Calcuation of eigenvalues
+        dsyev_( &jovz, &uplo, (__CLPK_integer *) &n, A, (__CLPK_integer *) &n,
+                W, WORK, (__CLPK_integer *) &lwork, (__CLPK_integer *) &info );
+
+        double var = eigenFeature( W[2], W[1], W[0] );
+
+        if ( m_isEstimateNormal && isLargest )
+          storeNormal( m_normal, i, point, A, W[0] + W[1] + W[2] );
+
+        m_multiScaleFeature[i * K + k] = var;
+        if ( localMax[k] < var )
+          localMax[k] = var;
+      }
 
-    if ( sum < EPSILON )
-      var = 0.0;
+      if ( !((i + 1) % INTERVAL) )
+        std::cout << i + 1 << ", " << n0 << ": " << m_multiScaleFeature[i * K + K - 1] << std::endl;
+    }
 
-    //--- Contributing rate of 3rd(minimum) component
-    featureValues.push_back( var );
-    if ( sigMax < var )
-      sigMax = var;
+    //--- Maximum of each scale over the threads
+#pragma omp critical
+    for ( int k = 0; k < K; k++ )
+      if ( sigMax[k] < localMax[k] )
+        sigMax[k] = localMax[k];
+  }
 
-    if ( !((i + 1) % INTERVAL) )
-      std::cout << i + 1 << ", " << n0 << ": " << var << std::endl;
+  delete myTree;
+  delete[] mrange;
 
+  // Normalize feature values channel by channel
+  for ( int k = 0; k < K; k++ )
+  {
+    std::cout << "Maximun of Sigma ( radius " << m_scaleRadii[k] << " ) : " << sigMax[k] << std::endl;
+    if ( sigMax[k] <= 0.0 )
+      continue;
+    for ( size_t i = 0; i < numVert; i++ )
+      m_multiScaleFeature[i * K + k] /= sigMax[k];
   }
 
+  // The largest radius is used as the single-channel feature
+  m_feature.resize( numVert );
+  for ( size_t i = 0; i < numVert; i++ )
+    m_feature[i] = m_multiScaleFeature[i * K + K - 1];
+
   m_maxFeature = 1.0;
-  std::cout << "Maximun of Sigma : " << sigMax << std::endl;
+}
 
-  // Normalize feature values
-  float normFt;
-  std::vector<float> ft;
+// --- Calculate feature values with a per-point radius given by the distance
+//     to the k-th nearest neighbor, clamped to [ minimum, maximum ] radius.
+//     Where the k-th neighbor is closer than the minimum radius, all the points
+//     within the minimum radius are used, so a point may have more than k neighbors.
+void calculateFeature::calcAdaptiveRadiusFeature( kvs::PolygonObject *ply )
+{
+  int number_of_neighbors;
+  double min_local_area_radius, max_local_area_radius;
+
+  std::cout << "Highlighting precision" << std::endl;
+  std::cout << "Input number of nearest neighbors k >> ";
+  std::cin  >> number_of_neighbors;
+  inputMinMaxSearchRadius( ply, min_local_area_radius, max_local_area_radius );
 
-  for ( float f : featureValues )
+  if ( number_of_neighbors < DIM )
   {
-    normFt = f / sigMax;
-    ft.push_back( normFt );
+    std::cout << "Number of nearest neighbors must be at least " << DIM << std::endl;
+    exit( 1 );
   }
 
-  return ft;
-}
+  if ( min_local_area_radius > max_local_area_radius )
+    std::swap( min_local_area_radius, max_local_area_radius );
+
+  std::cout << "Minimum local-area radius = " << min_local_area_radius << std::endl;
+  std::cout << "Maximum local-area radius = " << max_local_area_radius << std::endl;
+  std::cout << std::endl;
 
-std::vector<double> calculateFeature::calcEigenValues( kvs::PolygonObject* ply, double radius )
-{
   ply->updateMinMaxCoords();
   kvs::ValueArray<kvs::Real32> coords = ply->coords();
   float *pdata = coords.data();
@@ -847,114 +1139,1540 @@ std::vector<double> calculateFeature::calcEigenValues( kvs::PolygonObject* ply,
             << maxBB << std::endl;
   octree *myTree = new octree( pdata, numVert, mrange, MIN_NODE );
 
-  kvs::MersenneTwister uniRand;
-
-  std::vector<double> eigenValues;
+  std::vector<float> featureValues( numVert );
+  double sigMax = 0.0;
+  double sumRadius = 0.0;
+  size_t sumNeighbors = 0;
+  size_t numClampedMin = 0, numClampedMax = 0;
 
   std::cout << "Start OCtree Search..... " << std::endl;
-  for ( size_t i = 0; i < numVert; i++ )
+#pragma omp parallel
   {
-    if (i == numVert)
-      --i;
-    double point[3] = { coords[3 * i],
-                        coords[3 * i + 1],
-                        coords[3 * i + 2] };
-
     vector<size_t> nearInd;
     vector<double> dist;
-    search_points( point, radius, pdata, myTree->octreeRoot, &nearInd, &dist );
-    int n0 = (int)nearInd.size();
+    NeighborBuffer buf;
 
-    //--- Standardization for x, y, z
-    double xb = 0.0, yb = 0.0, zb = 0.0;
-    for (int j = 0; j < n0; j++)
+#pragma omp for schedule(dynamic, 256) reduction(max:sigMax) reduction(+:sumRadius,sumNeighbors,numClampedMin,numClampedMax)
+    for ( long i = 0; i < (long)numVert; i++ )
     {
-
-      double x = coords[3 * nearInd[j]];
-      double y = coords[3 * nearInd[j] + 1];
-      double z = coords[3 * nearInd[j] + 2];
-
-      xb += x;
-      yb += y;
-      zb += z;
+      double point[3] = { coords[3 * i],
+                          coords[3 * i + 1],
+                          coords[3 * i + 2] };
+
+      nearInd.clear();
+      dist.clear();
+      search_nearest_points( point, number_of_neighbors, max_local_area_radius,
+                             pdata, myTree->octreeRoot, mrange, &nearInd, &dist );
+
+      double radius = max_local_area_radius;
+      if ( (int)nearInd.size() == number_of_neighbors )
+        radius = dist[number_of_neighbors - 1];
+      else
+        numClampedMax++;
+
+      //--- Too dense: use all the points within the minimum radius
+      if ( radius < min_local_area_radius )
+      {
+        radius = min_local_area_radius;
+        nearInd.clear();
+        dist.clear();
+        search_points( point, radius, pdata, myTree->octreeRoot, &nearInd, &dist );
+        numClampedMin++;
+      }
+      int n0 = (int)nearInd.size();
+
+      //--- Covariance matrix ( xx, yy, zz, xy, yz, zx ) of the gathered neighbors
+      double mean[3];
+      double C[6];
+      double A[DIM * DIM];
+      double W[DIM];
+      gatherNeighbors( pdata, nearInd, buf, mean );
+      gatheredCovariance( buf, mean, C );
+      covarianceEigen( C, m_isEstimateNormal ? 'V' : 'N', A, W );
+
+      double var = eigenFeature( W[2], W[1], W[0] );
+      if ( m_isEstimateNormal )
+        storeNormal( m_normal, i, point, A, W[0] + W[1] + W[2] );
+
+      featureValues[i] = var;
+      if ( sigMax < var )
+        sigMax = var;
+
+      sumRadius    += radius;
+      sumNeighbors += n0;
+
+      if ( !((i + 1) % INTERVAL) )
+        std::cout << i + 1 << ", " << n0 << ", radius " << radius << ": " << var << std::endl;
     }
+  }
 
-    xb /= (double)n0;
-    yb /= (double)n0;
-    zb /= (double)n0;
-
-    //--- Calculaton of covariance matrix
-    double xx = 0.0, yy = 0.0, zz = 0.0;
-    double xy = 0.0, yz = 0.0, zx = 0.0;
-    for (int j = 0; j < n0; j++)
-    {
-
-      double nx = ( coords[3 * nearInd[j]] - xb );
-      double ny = ( coords[3 * nearInd[j] + 1] - yb );
-      double nz = ( coords[3 * nearInd[j] + 2] - zb );
-      xx += nx * nx;
-      yy += ny * ny;
-      zz += nz * nz;
-      xy += nx * ny;
-      yz += ny * nz;
-      zx += nz * nx;
-    }
+  delete myTree;
+  delete[] mrange;
 
-    double s_xx = xx / (double)(n0);
-    double s_yy = yy / (double)(n0);
-    double s_zz = zz / (double)(n0);
-    double s_xy = xy / (double)(n0);
-    double s_yz = yz / (double)(n0);
-    double s_zx = zx / (double)(n0);
+  std::cout << "Average local-area radius : " << sumRadius / (double)numVert << std::endl;
+  std::cout << "Average number of neighbors : " << (double)sumNeighbors / (double)numVert << std::endl;
+  std::cout << "Clamped to minimum radius : " << numClampedMin
+            << ", to maximum radius : " << numClampedMax << std::endl;
 
-    // double s_yx = s_xy;
-    // double s_zy = s_yz;
-    // double s_xz = s_zx;
+  m_maxFeature = 1.0;
+  std::cout << "Maximun of Sigma : " << sigMax << std::endl;
 
-    /***
+  // Normalize feature values
+  m_feature.resize( numVert );
+  for ( size_t i = 0; i < numVert; i++ )
+    m_feature[i] = ( sigMax > 0.0 ) ? featureValues[i] / sigMax : 0.0;
+}
+
+// --- Calculate feature values on a voxel-subsampled cloud, interpolate them to
+//     all points, and recalculate at full resolution only near large features.
+void calculateFeature::calcCoarseToFineFeature( kvs::PolygonObject *ply )
+{
+  double voxel_ratio;
+  double refine_threshold;
+
+  std::cout << "Input voxel size / local-area radius (recommend range [0.2-0.5]) >> ";
+  std::cin  >> voxel_ratio;
+  std::cout << "Input refinement threshold in range [0, 1] (slightly below f_th) >> ";
+  std::cin  >> refine_threshold;
+  std::cout << std::endl;
+
+  if ( voxel_ratio <= 0.0 )
+  {
+    std::cout << "Voxel size must be positive" << std::endl;
+    exit( 1 );
+  }
+
+  ply->updateMinMaxCoords();
+  kvs::ValueArray<kvs::Real32> coords = ply->coords();
+  float *pdata = coords.data();
+  size_t numVert = ply->numberOfVertices();
+  kvs::Vector3f minBB = ply->minObjectCoord();
+  kvs::Vector3f maxBB = ply->maxObjectCoord();
+
+  double *mrange = new double[6];
+  mrange[0] = (double)minBB.x();
+  mrange[1] = (double)maxBB.x();
+  mrange[2] = (double)minBB.y();
+  mrange[3] = (double)maxBB.y();
+  mrange[4] = (double)minBB.z();
+  mrange[5] = (double)maxBB.z();
+
+  //--- Voxel subsampling ( centroid of each voxel )
+  double voxel = m_searchRadius * voxel_ratio;
+  const unsigned long long keyMax = ( 1ULL << COARSE_KEY_BITS ) - 1;
+  for ( int k = 0; k < 3; k++ )
+  {
+    if ( ( mrange[2 * k + 1] - mrange[2 * k] ) / voxel >= (double)keyMax )
+    {
+      std::cout << "ERROR: Voxel size is too small ( more than "
+                << keyMax << " voxels per axis )" << std::endl;
+      exit( 1 );
+    }
+  }
+  //--- Cells of the points: ( key, point ) pairs sorted in parallel, one coarse point per run of a key
+  std::vector< std::pair<unsigned long long, size_t> > keys( numVert );
+#pragma omp parallel for
+  for ( long i = 0; i < (long)numVert; i++ )
+  {
+    unsigned long long ix = (unsigned long long)( ( coords[3 * i]     - mrange[0] ) / voxel );
+    unsigned long long iy = (unsigned long long)( ( coords[3 * i + 1] - mrange[2] ) / voxel );
+    unsigned long long iz = (unsigned long long)( ( coords[3 * i + 2] - mrange[4] ) / voxel );
+    keys[i].first  = ( ix << ( 2 * COARSE_KEY_BITS ) ) | ( iy << COARSE_KEY_BITS ) | iz;
+    keys[i].second = i;
+  }
+  parallelSortKeys( keys );
+
+  std::vector<size_t> cellStart;
+  for ( size_t i = 0; i < numVert; i++ )
+    if ( i == 0 || keys[i].first != keys[i - 1].first )
+      cellStart.push_back( i );
+  size_t numCoarse = cellStart.size();
+  cellStart.push_back( numVert );
+
+  std::vector<float> coarseCoords( 3 * numCoarse );
+#pragma omp parallel for
+  for ( long v = 0; v < (long)numCoarse; v++ )
+  {
+    double sum[3] = { 0.0, 0.0, 0.0 };
+    for ( size_t j = cellStart[v]; j < cellStart[v + 1]; j++ )
+      for ( int k = 0; k < 3; k++ )
+        sum[k] += coords[3 * keys[j].second + k];
+    double count = (double)( cellStart[v + 1] - cellStart[v] );
+    for ( int k = 0; k < 3; k++ )
+      coarseCoords[3 * v + k] = sum[k] / count;
+  }
+  std::vector< std::pair<unsigned long long, size_t> >().swap( keys );
+  std::vector<size_t>().swap( cellStart );
+
+  std::cout << "Voxel size = " << voxel << std::endl;
+  std::cout << "Number of coarse points : " << numCoarse << std::endl;
+
+  //--- Coarse features
+  std::cout << "Creating Octree... (Number of Vertex : " << numCoarse << std::endl;
+  octree *coarseTree = new octree( coarseCoords.data(), numCoarse, mrange, MIN_NODE );
+
+  std::vector<float> coarseFeature( numCoarse );
+  std::vector<float> coarseNormal( m_isEstimateNormal ? 3 * numCoarse : 0 );
+  double coarseMax = 0.0;
+
+  std::cout << "Start OCtree Search ( coarse )..... " << std::endl;
+#pragma omp parallel
+  {
+    vector<size_t> nearInd;
+    vector<double> dist;
+    NeighborBuffer buf;
+
+#pragma omp for schedule(dynamic, 256) reduction(max:coarseMax)
+    for ( long v = 0; v < (long)numCoarse; v++ )
+    {
+      double point[3] = { coarseCoords[3 * v],
+                          coarseCoords[3 * v + 1],
+                          coarseCoords[3 * v + 2] };
+
+      nearInd.clear();
+      dist.clear();
+      search_points( point, m_searchRadius, coarseCoords.data(), coarseTree->octreeRoot, &nearInd, &dist );
+      std::sort( nearInd.begin(), nearInd.end() );
+
+      double mean[3];
+      double C[6];
+      double A[DIM * DIM];
+      double W[DIM];
+      gatherNeighbors( coarseCoords.data(), nearInd, buf, mean );
+      gatheredCovariance( buf, mean, C );
+      covarianceEigen( C, m_isEstimateNormal ? 'V' : 'N', A, W );
+
+      coarseFeature[v] = eigenFeature( W[2], W[1], W[0] );
+      if ( m_isEstimateNormal )
+        storeNormal( coarseNormal, v, point, A, W[0] + W[1] + W[2] );
+      if ( coarseMax < coarseFeature[v] )
+        coarseMax = coarseFeature[v];
+    }
+  }
+
+  //--- Interpolation to all points ( inverse distance weighting )
+  const size_t NUM_INTERPOLATION = 8;
+  double interpolationRadius = 2.0 * voxel;
+  std::vector<float> featureValues( numVert );
+  std::vector<char> isRefine( numVert, 0 );
+
+#pragma omp parallel
+  {
+    vector<size_t> nearInd;
+    vector<double> dist;
+
+#pragma omp for schedule(dynamic, 256)
+    for ( long i = 0; i < (long)numVert; i++ )
+    {
+      double point[3] = { coords[3 * i],
+                          coords[3 * i + 1],
+                          coords[3 * i + 2] };
+
+      nearInd.clear();
+      dist.clear();
+      search_nearest_points( point, NUM_INTERPOLATION, interpolationRadius,
+                             coarseCoords.data(), coarseTree->octreeRoot, mrange, &nearInd, &dist );
+      int n0 = (int)nearInd.size();
+
+      double wsum = 0.0, fsum = 0.0, fmax = 0.0;
+      for ( int j = 0; j < n0; j++ )
+      {
+        double w = 1.0 / ( dist[j] + EPSILON );
+        wsum += w;
+        fsum += w * coarseFeature[nearInd[j]];
+        if ( fmax < coarseFeature[nearInd[j]] )
+          fmax = coarseFeature[nearInd[j]];
+      }
+      featureValues[i] = ( wsum > 0.0 ) ? fsum / wsum : 0.0;
+
+      if ( m_isEstimateNormal && n0 > 0 )
+      {
+        double cn[3] = { coarseNormal[3 * nearInd[0]],
+                         coarseNormal[3 * nearInd[0] + 1],
+                         coarseNormal[3 * nearInd[0] + 2] };
+        storeNormal( m_normal, i, point, cn, 1.0 );
+      }
+
+      //--- Any large coarse feature nearby: recalculate at full resolution
+      if ( n0 == 0 || ( coarseMax > 0.0 && fmax / coarseMax >= refine_threshold ) )
+        isRefine[i] = 1;
+    }
+  }
+
+  std::vector<size_t> refineInd;
+  for ( size_t i = 0; i < numVert; i++ )
+    if ( isRefine[i] )
+      refineInd.push_back( i );
+  std::vector<char>().swap( isRefine );
+
+  delete coarseTree;
+
+  std::cout << "Number of refined points : " << refineInd.size()
+            << " ( " << 100.0 * (double)refineInd.size() / (double)numVert << " % )" << std::endl;
+
+  //--- Full resolution features near edges
+  if ( !refineInd.empty() )
+  {
+    std::cout << "Creating Octree... (Number of Vertex : " << numVert << std::endl;
+    std::cout << minBB << " \n"
+              << maxBB << std::endl;
+    octree *myTree = new octree( pdata, numVert, mrange, MIN_NODE );
+
+    std::cout << "Start OCtree Search ( refinement )..... " << std::endl;
+#pragma omp parallel
+    {
+      vector<size_t> nearInd;
+      vector<double> dist;
+      NeighborBuffer buf;
+
+#pragma omp for schedule(dynamic, 256)
+      for ( long r = 0; r < (long)refineInd.size(); r++ )
+      {
+        size_t i = refineInd[r];
+        double point[3] = { coords[3 * i],
+                            coords[3 * i + 1],
+                            coords[3 * i + 2] };
+
+        nearInd.clear();
+        dist.clear();
+        search_points( point, m_searchRadius, pdata, myTree->octreeRoot, &nearInd, &dist );
+        std::sort( nearInd.begin(), nearInd.end() );
+
+        double mean[3];
+        double C[6];
+        double A[DIM * DIM];
+        double W[DIM];
+        gatherNeighbors( pdata, nearInd, buf, mean );
+        gatheredCovariance( buf, mean, C );
+        covarianceEigen( C, m_isEstimateNormal ? 'V' : 'N', A, W );
+
+        featureValues[i] = eigenFeature( W[2], W[1], W[0] );
+        if ( m_isEstimateNormal )
+          storeNormal( m_normal, i, point, A, W[0] + W[1] + W[2] );
+
+        if ( !((r + 1) % INTERVAL) )
+          std::cout << r + 1 << ", " << nearInd.size() << ": " << featureValues[i] << std::endl;
+      }
+    }
+    delete myTree;
+  }
+
+  delete[] mrange;
+
+  double sigMax = 0.0;
+#pragma omp parallel for reduction(max:sigMax)
+  for ( long i = 0; i < (long)numVert; i++ )
+    if ( sigMax < featureValues[i] )
+      sigMax = featureValues[i];
+
+  m_maxFeature = 1.0;
+  std::cout << "Maximun of Sigma : " << sigMax << std::endl;
+
+  // Normalize feature values
+  m_feature.resize( numVert );
+#pragma omp parallel for
+  for ( long i = 0; i < (long)numVert; i++ )
+    m_feature[i] = ( sigMax > 0.0 ) ? featureValues[i] / sigMax : 0.0;
+}
+
+// --- Feature values of a triangle ( or quadrangle ) mesh from dihedral angles.
+//     An edge table is built by sorting ( vertex pair, face ) entries, the dihedral angle of
+//     each edge is the angle between the normals of its faces, and the feature value of a
+//     vertex is the largest angle of its edges. No neighbor search is needed.
+void calculateFeature::calcMeshDihedralFeature( kvs::PolygonObject *ply )
+{
+  size_t numVert = ply->numberOfVertices();
+  size_t numFace = ply->numberOfConnections();
+  if ( numFace == 0 )
+  {
+    std::cout << "ERROR: Mesh dihedral angle needs a PLY file with faces" << std::endl;
+    exit( 1 );
+  }
+  int numCorner = ( ply->polygonType() == kvs::PolygonObject::Quadrangle ) ? 4 : 3;
+
+  kvs::ValueArray<kvs::Real32> coords = ply->coords();
+  kvs::ValueArray<kvs::UInt32> connections = ply->connections();
+  const float *pdata = coords.data();
+  const kvs::UInt32 *conn = connections.data();
+
+  //--- Face normals ( length = twice the area )
+  std::cout << "Calculating face normals... (Number of Faces : " << numFace << std::endl;
+  std::vector<double> faceNormal( 3 * numFace, 0.0 );
+#pragma omp parallel for
+  for ( long f = 0; f < (long)numFace; f++ )
+  {
+    const kvs::UInt32 *v = &conn[numCorner * f];
+    const float *p0 = &pdata[3 * v[0]];
+    const float *p1 = &pdata[3 * v[1]];
+    const float *p2 = &pdata[3 * v[2]];
+    double a[3], b[3];
+    for ( int k = 0; k < 3; k++ )
+    {
+      a[k] = p1[k] - p0[k];
+      b[k] = p2[k] - p0[k];
+    }
+    if ( numCorner == 4 )
+    {
+      //--- Diagonals of the quadrangle
+      const float *p3 = &pdata[3 * v[3]];
+      for ( int k = 0; k < 3; k++ )
+      {
+        a[k] = p2[k] - p0[k];
+        b[k] = p3[k] - p1[k];
+      }
+    }
+    faceNormal[3 * f]     = a[1] * b[2] - a[2] * b[1];
+    faceNormal[3 * f + 1] = a[2] * b[0] - a[0] * b[2];
+    faceNormal[3 * f + 2] = a[0] * b[1] - a[1] * b[0];
+  }
+
+  //--- Edge table: ( smaller vertex, larger vertex ) -> faces
+  std::vector< std::pair<unsigned long long, size_t> > edges( numCorner * numFace );
+#pragma omp parallel for
+  for ( long f = 0; f < (long)numFace; f++ )
+  {
+    const kvs::UInt32 *v = &conn[numCorner * f];
+    for ( int c = 0; c < numCorner; c++ )
+    {
+      unsigned long long v0 = v[c];
+      unsigned long long v1 = v[( c + 1 ) % numCorner];
+      if ( v0 > v1 )
+        std::swap( v0, v1 );
+      edges[numCorner * f + c].first  = ( v0 << 32 ) | v1;
+      edges[numCorner * f + c].second = f;
+    }
+  }
+  std::sort( edges.begin(), edges.end() );
+
+  std::vector<size_t> edgeStart;
+  for ( size_t e = 0; e < edges.size(); e++ )
+    if ( e == 0 || edges[e].first != edges[e - 1].first )
+      edgeStart.push_back( e );
+  long numEdge = (long)edgeStart.size();
+  edgeStart.push_back( edges.size() );
+
+  //--- Dihedral angle of each edge ( boundary edges: 0 )
+  std::vector<double> edgeAngle( numEdge, 0.0 );
+  long numBoundary = 0, numNonManifold = 0;
+#pragma omp parallel for reduction(+:numBoundary,numNonManifold)
+  for ( long e = 0; e < numEdge; e++ )
+  {
+    size_t begin = edgeStart[e];
+    size_t end   = edgeStart[e + 1];
+    if ( end - begin < 2 )
+    {
+      numBoundary++;
+      continue;
+    }
+    if ( end - begin > 2 )
+      numNonManifold++;
+
+    double angle = 0.0;
+    for ( size_t a = begin; a < end; a++ )
+    {
+      for ( size_t b = a + 1; b < end; b++ )
+      {
+        const double *na = &faceNormal[3 * edges[a].second];
+        const double *nb = &faceNormal[3 * edges[b].second];
+        double la = sqrt( na[0] * na[0] + na[1] * na[1] + na[2] * na[2] );
+        double lb = sqrt( nb[0] * nb[0] + nb[1] * nb[1] + nb[2] * nb[2] );
+        if ( la < EPSILON || lb < EPSILON )
+          continue;
+        double c = ( na[0] * nb[0] + na[1] * nb[1] + na[2] * nb[2] ) / ( la * lb );
+        c = std::max( -1.0, std::min( 1.0, c ) );
+        angle = std::max( angle, acos( c ) );
+      }
+    }
+    edgeAngle[e] = angle;
+  }
+
+  //--- Largest angle around each vertex
+  std::vector<double> featureValues( numVert, 0.0 );
+  for ( long e = 0; e < numEdge; e++ )
+  {
+    size_t v0 = (size_t)( edges[edgeStart[e]].first >> 32 );
+    size_t v1 = (size_t)( edges[edgeStart[e]].first & 0xffffffffULL );
+    featureValues[v0] = std::max( featureValues[v0], edgeAngle[e] );
+    featureValues[v1] = std::max( featureValues[v1], edgeAngle[e] );
+  }
+
+  //--- Area-weighted vertex normals
+  if ( m_isEstimateNormal )
+  {
+    std::vector<double> vn( 3 * numVert, 0.0 );
+    for ( size_t f = 0; f < numFace; f++ )
+      for ( int c = 0; c < numCorner; c++ )
+        for ( int k = 0; k < 3; k++ )
+          vn[3 * conn[numCorner * f + c] + k] += faceNormal[3 * f + k];
+    for ( size_t i = 0; i < numVert; i++ )
+    {
+      double len = sqrt( vn[3 * i] * vn[3 * i] + vn[3 * i + 1] * vn[3 * i + 1] + vn[3 * i + 2] * vn[3 * i + 2] );
+      if ( len < EPSILON )
+        continue;
+      for ( int k = 0; k < 3; k++ )
+        m_normal[3 * i + k] = vn[3 * i + k] / len;
+    }
+  }
+
+  std::cout << "Number of edges : " << numEdge << " ( boundary: " << numBoundary
+            << ", non-manifold: " << numNonManifold << " )" << std::endl;
+
+  double sigMax = 0.0;
+  for ( size_t i = 0; i < numVert; i++ )
+    if ( sigMax < featureValues[i] )
+      sigMax = featureValues[i];
+
+  m_maxFeature = 1.0;
+  std::cout << "Maximun of dihedral angle : " << sigMax * 180.0 / M_PI << " deg" << std::endl;
+
+  // Normalize feature values
+  m_feature.resize( numVert );
+  for ( size_t i = 0; i < numVert; i++ )
+    m_feature[i] = ( sigMax > 0.0 ) ? featureValues[i] / sigMax : 0.0;
+}
+
+// --- Points of the region of interest and of the halo around it.
+//     The halo is the ROI bounding box widened by the local-area radius, so that every
+//     neighbor of an ROI point is kept and the features of the ROI points are exact.
+//     Returns the cropped cloud; m_roiIndex holds the ROI points in the input cloud and
+//     m_previewIndex the ROI points in the cropped cloud ( features only at these points ).
+kvs::PolygonObject* calculateFeature::cropRegionOfInterest( kvs::PolygonObject *ply )
+{
+  kvs::ValueArray<kvs::Real32> coords  = ply->coords();
+  kvs::ValueArray<kvs::Real32> normals = ply->normals();
+  kvs::ValueArray<kvs::UInt8>  colors  = ply->colors();
+  size_t numVert = ply->numberOfVertices();
+  bool hasNormal = ( numVert == ply->numberOfNormals() );
+  bool hasColor  = ( numVert == ply->numberOfColors() );
+
+  //--- ROI points and their bounding box
+  kvs::Vector3f roiMin = m_roiMin;
+  kvs::Vector3f roiMax = m_roiMax;
+  if ( m_isRoiBox )
+  {
+    m_roiIndex.clear();
+    for ( size_t i = 0; i < numVert; i++ )
+    {
+      bool inside = true;
+      for ( int k = 0; k < 3; k++ )
+        if ( coords[3 * i + k] < roiMin[k] || coords[3 * i + k] > roiMax[k] )
+          inside = false;
+      if ( inside )
+        m_roiIndex.push_back( i );
+    }
+  }
+  else
+  {
+    for ( size_t r = 0; r < m_roiIndex.size(); r++ )
+    {
+      size_t i = m_roiIndex[r];
+      if ( i >= numVert )
+      {
+        std::cout << "ERROR: ROI index " << i << " is out of range ( " << numVert << " points )" << std::endl;
+        exit( 1 );
+      }
+      for ( int k = 0; k < 3; k++ )
+      {
+        if ( r == 0 || coords[3 * i + k] < roiMin[k] ) roiMin[k] = coords[3 * i + k];
+        if ( r == 0 || coords[3 * i + k] > roiMax[k] ) roiMax[k] = coords[3 * i + k];
+      }
+    }
+  }
+  if ( m_roiIndex.empty() )
+  {
+    std::cout << "ERROR: No points in the region of interest" << std::endl;
+    exit( 1 );
+  }
+
+  //--- ROI and halo points ( in the input order )
+  std::vector<char> isRoi( numVert, 0 );
+  for ( size_t r = 0; r < m_roiIndex.size(); r++ )
+    isRoi[ m_roiIndex[r] ] = 1;
+
+  std::vector<kvs::Real32> cropCoords, cropNormals;
+  std::vector<kvs::UInt8> cropColors;
+  m_previewIndex.clear();
+  for ( size_t i = 0; i < numVert; i++ )
+  {
+    bool inside = true;
+    for ( int k = 0; k < 3; k++ )
+      if ( coords[3 * i + k] < roiMin[k] - m_searchRadius || coords[3 * i + k] > roiMax[k] + m_searchRadius )
+        inside = false;
+    if ( !inside && !isRoi[i] )
+      continue;
+
+    if ( isRoi[i] )
+      m_previewIndex.push_back( cropCoords.size() / 3 );
+    for ( int k = 0; k < 3; k++ )
+    {
+      cropCoords.push_back( coords[3 * i + k] );
+      if ( hasNormal ) cropNormals.push_back( normals[3 * i + k] );
+      if ( hasColor )  cropColors.push_back( colors[3 * i + k] );
+    }
+  }
+
+  kvs::PolygonObject *crop = new kvs::PolygonObject();
+  crop->setPolygonType( kvs::PolygonObject::UnknownPolygonType );
+  crop->setColorType( kvs::PolygonObject::VertexColor );
+  crop->setNormalType( kvs::PolygonObject::VertexNormal );
+  crop->setCoords( kvs::ValueArray<kvs::Real32>( cropCoords ) );
+  crop->setNormals( kvs::ValueArray<kvs::Real32>( cropNormals ) );
+  crop->setColors( kvs::ValueArray<kvs::UInt8>( cropColors ) );
+  crop->updateMinMaxCoords();
+
+  std::cout << "Region of interest : " << m_roiIndex.size() << " points ( with halo: "
+            << crop->numberOfVertices() << " / " << numVert << " )" << std::endl;
+  std::cout << std::endl;
+
+  return crop;
+}
+
+// --- Incremental Point PCA for points appended to a computed cloud.
+//     The first m_oldFeature.size() points are the old points with their ( normalized )
+//     features, the rest are new points. Only the new points and the old points within the
+//     radius of a new point are recomputed. The old normalization is estimated from one
+//     unaffected old point, whose raw feature does not change, and all the features are
+//     normalized by the maximum over the merged cloud. The old features are read from the
+//     printed output, so the unaffected points agree with a full run only to that precision.
+void calculateFeature::calcIncrementalFeature( kvs::PolygonObject *ply )
+{
+  ply->updateMinMaxCoords();
+
+  //--- Features of another radius or type cannot be mixed with the recomputed ones
+  if ( m_oldRadius <= 0.0 || m_oldFeatureValueID < 0 )
+  {
+    std::cout << "Radius and feature value type of the previous run are not recorded in the input:"
+              << " they must be the same as in this run" << std::endl;
+  }
+  if ( m_oldRadius > 0.0 && fabs( m_searchRadius - m_oldRadius ) > INCREMENTAL_RADIUS_TOLERANCE * m_oldRadius )
+  {
+    kvs::Vector3f bb = ply->maxObjectCoord() - ply->minObjectCoord();
+    std::cout << "ERROR: Local-area radius " << m_searchRadius
+              << " differs from the radius of the previous run " << m_oldRadius << std::endl;
+    std::cout << "       ( 1/local-area_radius for the previous radius: "
+              << std::setprecision( 10 ) << bb.length() / m_oldRadius << " )" << std::endl;
+    exit( 1 );
+  }
+  if ( m_oldFeatureValueID >= 0 && m_oldFeatureValueID != (int)m_feature_id )
+  {
+    std::cout << "ERROR: Feature value type " << m_feature_id
+              << " differs from the type of the previous run " << m_oldFeatureValueID << std::endl;
+    exit( 1 );
+  }
+
+  kvs::ValueArray<kvs::Real32> coords  = ply->coords();
+  kvs::ValueArray<kvs::Real32> normals = ply->normals();
+  float *pdata = coords.data();
+  size_t numVert = ply->numberOfVertices();
+  size_t numOld  = m_oldFeature.size();
+  kvs::Vector3f minBB = ply->minObjectCoord();
+  kvs::Vector3f maxBB = ply->maxObjectCoord();
+
+  double *mrange = new double[6];
+  mrange[0] = (double)minBB.x();
+  mrange[1] = (double)maxBB.x();
+  mrange[2] = (double)minBB.y();
+  mrange[3] = (double)maxBB.y();
+  mrange[4] = (double)minBB.z();
+  mrange[5] = (double)maxBB.z();
+
+  // create octree
+  std::cout << "Creating Octree... (Number of Vertex : " << numVert << std::endl;
+  std::cout << minBB << " \n"
+            << maxBB << std::endl;
+  octree *myTree = new octree( pdata, numVert, mrange, MIN_NODE );
+
+  //--- New points and the old points in their local areas
+  std::vector<char> isAffected( numVert, 0 );
+#pragma omp parallel for schedule(dynamic, 256)
+  for ( long i = (long)numOld; i < (long)numVert; i++ )
+  {
+    double point[3] = { coords[3 * i],
+                        coords[3 * i + 1],
+                        coords[3 * i + 2] };
+
+    vector<size_t> nearInd;
+    vector<double> dist;
+    search_points( point, m_searchRadius, pdata, myTree->octreeRoot, &nearInd, &dist );
+    //--- Points near several new points are marked by several threads
+#pragma omp atomic write
+    isAffected[i] = 1;
+    for ( size_t j = 0; j < nearInd.size(); j++ )
+    {
+#pragma omp atomic write
+      isAffected[nearInd[j]] = 1;
+    }
+  }
+
+  //--- Reference point: unaffected old point with the largest feature
+  //    ( only when the maximum of the previous run is not recorded in the input )
+  size_t ref = numVert;
+  size_t numKept = 0;
+  for ( size_t i = 0; i < numOld; i++ )
+  {
+    if ( isAffected[i] || m_oldFeature[i] <= 0.0f )
+      continue;
+    numKept++;
+    if ( m_oldRawMax <= 0.0 && ( ref == numVert || m_oldFeature[i] > m_oldFeature[ref] ) )
+      ref = i;
+  }
+
+  std::vector<size_t> computeInd;
+  for ( size_t i = 0; i < numVert; i++ )
+    if ( isAffected[i] || i == ref )
+      computeInd.push_back( i );
+
+  std::cout << "Recomputed points : " << computeInd.size() << " / " << numVert
+            << " ( new: " << numVert - numOld << " )" << std::endl;
+
+  //--- Raw features of the recomputed points
+  std::vector<double> featureValues( numVert, 0.0 );
+  if ( m_isEstimateNormal && normals.size() == 3 * numVert )
+    for ( size_t i = 0; i < 3 * numOld; i++ )
+      m_normal[i] = normals[i];
+
+#pragma omp parallel for schedule(dynamic, 256)
+  for ( long c = 0; c < (long)computeInd.size(); c++ )
+  {
+    size_t i = computeInd[c];
+    double point[3] = { coords[3 * i],
+                        coords[3 * i + 1],
+                        coords[3 * i + 2] };
+
+    vector<size_t> nearInd;
+    vector<double> dist;
+    search_points( point, m_searchRadius, pdata, myTree->octreeRoot, &nearInd, &dist );
+
+    double A[DIM * DIM];
+    double W[DIM];
+    calcNeighborEigen( pdata, nearInd, m_isEstimateNormal ? 'V' : 'N', A, W );
+
+    featureValues[i] = eigenFeature( W[2], W[1], W[0] );
+    if ( m_isEstimateNormal )
+      storeNormal( m_normal, i, point, A, W[0] + W[1] + W[2] );
+  }
+  delete myTree;
+  delete[] mrange;
+
+  //--- Raw features of the unaffected old points ( old normalization: recorded maximum,
+  //    otherwise estimated from the reference point to the printed precision )
+  double oldMax = m_oldRawMax;
+  if ( numKept > 0 )
+  {
+    if ( oldMax > 0.0 )
+      std::cout << "Maximun of Sigma ( old, recorded ) : " << oldMax << std::endl;
+    else
+    {
+      oldMax = featureValues[ref] / m_oldFeature[ref];
+      std::cout << "Maximun of Sigma ( old, estimated from point " << ref << " ) : " << oldMax << std::endl;
+    }
+    if ( !( oldMax > 0.0 ) || std::isinf( oldMax ) )
+    {
+      std::cout << "ERROR: Cannot rescale the features of the previous run ( maximum " << oldMax << " )" << std::endl;
+      exit( 1 );
+    }
+  }
+  else
+    std::cout << "No unaffected old point has a nonzero feature: the maximum of the previous run is not used" << std::endl;
+  for ( size_t i = 0; i < numOld; i++ )
+    if ( !isAffected[i] )
+      featureValues[i] = m_oldFeature[i] * oldMax;
+
+  double sigMax = 0.0;
+  for ( size_t i = 0; i < numVert; i++ )
+    if ( sigMax < featureValues[i] )
+      sigMax = featureValues[i];
+
+  m_maxFeature = 1.0;
+  m_rawMaxFeature = sigMax;
+  std::cout << "Maximun of Sigma : " << sigMax << std::endl;
+
+  // Normalize feature values
+  m_feature.resize( numVert );
+  for ( size_t i = 0; i < numVert; i++ )
+    m_feature[i] = ( sigMax > 0.0 ) ? featureValues[i] / sigMax : 0.0;
+}
+
+// --- Covariance matrix of the neighbors and its eigenvalues ( W[0] <= W[1] <= W[2] ).
+//     With jobz = 'V', A returns the eigenvectors column by column.
+void calculateFeature::calcNeighborEigen( const float *coords, const std::vector<size_t> &nearInd,
+                                          char jobz, double A[], double W[] )
+{
+  int n0 = (int)nearInd.size();
+
+  W[0] = W[1] = W[2] = 0.0;
+  if ( n0 == 0 )
+    return;
+
+  //--- Standardization for x, y, z
+  double xb = 0.0, yb = 0.0, zb = 0.0;
+  for ( int j = 0; j < n0; j++ )
+  {
+    xb += coords[3 * nearInd[j]];
+    yb += coords[3 * nearInd[j] + 1];
+    zb += coords[3 * nearInd[j] + 2];
+  }
+  xb /= (double)n0;
+  yb /= (double)n0;
+  zb /= (double)n0;
+
+  //--- Calculaton of covariance matrix
+  double xx = 0.0, yy = 0.0, zz = 0.0;
+  double xy = 0.0, yz = 0.0, zx = 0.0;
+  for ( int j = 0; j < n0; j++ )
+  {
+    double nx = ( coords[3 * nearInd[j]] - xb );
+    double ny = ( coords[3 * nearInd[j] + 1] - yb );
+    double nz = ( coords[3 * nearInd[j] + 2] - zb );
+    xx += nx * nx;
+    yy += ny * ny;
+    zz += nz * nz;
+    xy += nx * ny;
+    yz += ny * nz;
+    zx += nz * nx;
+  }
+
+  //--- Preparation for LAPACK
+  int n     = DIM;
+  char uplo = 'U';
+  int lwork = n*n;
+  double WORK[n*n];
+  int info;
+
+  //---- Covariance matrix
+  A[0] = xx / (double)n0; A[3] = xy / (double)n0; A[6] = zx / (double)n0;
+  A[1] = 0.0            ; A[4] = yy / (double)n0; A[7] = yz / (double)n0;
+  A[2] = 0.0            ; A[5] = 0.0            ; A[8] = zz / (double)n0;
+
+  //---- Calcuation of eigenvalues and egenvectors
+  dsyev_( &jobz, &uplo, (__CLPK_integer *) &n, A, (__CLPK_integer *) &n,
+          W, WORK, (__CLPK_integer *) &lwork, (__CLPK_integer *) &info );
+}
+
+// --- Local-area radius from the measured point spacing.
+//     The distance d_k to the k-th nearest neighbor of randomly sampled points gives the
+//     surface density k / ( pi d_k^2 ) ( median over the samples ), and the radius is chosen
+//     so that a local area holds about AUTO_NEIGHBORS points ( the radius range for
+//     multi-radius modes holds AUTO_MIN_NEIGHBORS to AUTO_MAX_NEIGHBORS points ).
+void calculateFeature::estimateSearchRadius( kvs::PolygonObject *ply )
+{
+  ply->updateMinMaxCoords();
+  kvs::ValueArray<kvs::Real32> coords = ply->coords();
+  float *pdata = coords.data();
+  size_t numVert = ply->numberOfVertices();
+  kvs::Vector3f minBB = ply->minObjectCoord();
+  kvs::Vector3f maxBB = ply->maxObjectCoord();
+  double diag = ( maxBB - minBB ).length();
+
+  double *mrange = new double[6];
+  mrange[0] = (double)minBB.x();
+  mrange[1] = (double)maxBB.x();
+  mrange[2] = (double)minBB.y();
+  mrange[3] = (double)maxBB.y();
+  mrange[4] = (double)minBB.z();
+  mrange[5] = (double)maxBB.z();
+
+  // create octree
+  std::cout << "Creating Octree... (Number of Vertex : " << numVert << std::endl;
+  octree *myTree = new octree( pdata, numVert, mrange, MIN_NODE );
+
+  kvs::MersenneTwister uniRand;
+  std::vector<double> kthDist;
+
+  std::cout << "Measuring point spacing..... " << std::endl;
+  for ( int s = 0; s < SPACING_SAMPLES; s++ )
+  {
+    size_t i = (size_t)( (double)numVert * uniRand() );
+    if ( i == numVert )
+      --i;
+    double point[3] = { coords[3 * i],
+                        coords[3 * i + 1],
+                        coords[3 * i + 2] };
+
+    vector<size_t> nearInd;
+    vector<double> dist;
+    search_nearest_points( point, SPACING_NEIGHBORS + 1, diag,
+                           pdata, myTree->octreeRoot, mrange, &nearInd, &dist );
+    if ( (int)dist.size() == SPACING_NEIGHBORS + 1 && dist.back() > 0.0 )
+      kthDist.push_back( dist.back() );
+  }
+  delete myTree;
+  delete[] mrange;
+
+  if ( kthDist.empty() )
+  {
+    std::cout << "ERROR: Cannot measure point spacing" << std::endl;
+    exit( 1 );
+  }
+  std::nth_element( kthDist.begin(), kthDist.begin() + kthDist.size() / 2, kthDist.end() );
+  double dk = kthDist[kthDist.size() / 2];
+
+  m_pointSpacing   = dk * sqrt( M_PI / (double)SPACING_NEIGHBORS );
+  m_autoRadius     = dk * sqrt( AUTO_NEIGHBORS / (double)SPACING_NEIGHBORS );
+  m_autoMinRadius  = dk * sqrt( AUTO_MIN_NEIGHBORS / (double)SPACING_NEIGHBORS );
+  m_autoMaxRadius  = dk * sqrt( AUTO_MAX_NEIGHBORS / (double)SPACING_NEIGHBORS );
+
+  std::cout << "Point spacing ( median of " << kthDist.size() << " samples ) = " << m_pointSpacing << std::endl;
+  std::cout << "Recommended local-area radius = " << m_autoRadius
+            << " ( 1/local-area_radius = " << diag / m_autoRadius << " )" << std::endl;
+  std::cout << "Recommended radius range      = [" << m_autoMinRadius << ", " << m_autoMaxRadius
+            << "] ( 1/local-area_radius = [" << diag / m_autoMaxRadius << "-" << diag / m_autoMinRadius << "] )" << std::endl;
+  std::cout << std::endl;
+}
+
+// --- Pre-pass for scenes dominated by planes.
+//     Points are binned into cells of the local-area radius, a plane is fitted to each cell,
+//     and neighboring coplanar cells are merged into regions. A point is interior when its
+//     cell and all occupied neighboring cells ( which hold its whole neighborhood ) are
+//     coplanar and belong to a large region; its feature value is 0 without PCA.
+void calculateFeature::calcPlaneSegmentation( kvs::PolygonObject *ply )
+{
+  double toleranceRatio;
+  std::cout << "Plane segmentation" << std::endl;
+  std::cout << "Input plane tolerance / local-area radius (recommend range [0.01-0.05]) >> ";
+  std::cin  >> toleranceRatio;
+  double tolerance = toleranceRatio * m_searchRadius;
+
+  ply->updateMinMaxCoords();
+  kvs::ValueArray<kvs::Real32> coords = ply->coords();
+  float *pdata = coords.data();
+  size_t numVert = ply->numberOfVertices();
+  kvs::Vector3f minBB = ply->minObjectCoord();
+  kvs::Vector3f maxBB = ply->maxObjectCoord();
+
+  double cellSize = m_searchRadius;
+  const long long keyMax = ( 1LL << PLANE_KEY_BITS ) - 1;
+  for ( int k = 0; k < 3; k++ )
+  {
+    if ( ( maxBB[k] - minBB[k] ) / cellSize >= (double)keyMax )
+    {
+      std::cout << "Plane segmentation is skipped ( too many cells )" << std::endl;
+      return;
+    }
+  }
+
+  //--- Cell of each point
+  std::vector< std::pair<unsigned long long, size_t> > keys( numVert );
+#pragma omp parallel for
+  for ( long i = 0; i < (long)numVert; i++ )
+  {
+    unsigned long long c[3];
+    for ( int k = 0; k < 3; k++ )
+      c[k] = (unsigned long long)( ( pdata[3 * i + k] - minBB[k] ) / cellSize );
+    keys[i].first  = ( c[0] << ( 2 * PLANE_KEY_BITS ) ) | ( c[1] << PLANE_KEY_BITS ) | c[2];
+    keys[i].second = i;
+  }
+  std::sort( keys.begin(), keys.end() );
+
+  std::vector<unsigned long long> cellKey;
+  std::vector<size_t> cellStart;
+  for ( size_t i = 0; i < numVert; i++ )
+  {
+    if ( i == 0 || keys[i].first != keys[i - 1].first )
+    {
+      cellKey.push_back( keys[i].first );
+      cellStart.push_back( i );
+    }
+  }
+  long numCell = (long)cellKey.size();
+  cellStart.push_back( numVert );
+
+  //--- Plane of each cell ( normal, centroid )
+  std::vector<char> isPlanar( numCell, 0 );
+  std::vector<double> cellNormal( 3 * numCell, 0.0 );
+  std::vector<double> cellCenter( 3 * numCell, 0.0 );
+
+#pragma omp parallel for schedule(dynamic, 64)
+  for ( long c = 0; c < numCell; c++ )
+  {
+    size_t n0 = cellStart[c + 1] - cellStart[c];
+    if ( n0 < (size_t)MIN_PLANE_POINTS )
+      continue;
+
+    std::vector<size_t> cellInd( n0 );
+    double g[3] = { 0.0, 0.0, 0.0 };
+    for ( size_t j = 0; j < n0; j++ )
+    {
+      cellInd[j] = keys[cellStart[c] + j].second;
+      for ( int k = 0; k < 3; k++ )
+        g[k] += pdata[3 * cellInd[j] + k];
+    }
+    for ( int k = 0; k < 3; k++ )
+      g[k] /= (double)n0;
+
+    double A[DIM * DIM];
+    double W[DIM];
+    calcNeighborEigen( pdata, cellInd, 'V', A, W );
+
+    double maxDist = 0.0;
+    for ( size_t j = 0; j < n0; j++ )
+    {
+      double d = std::fabs( ( pdata[3 * cellInd[j]]     - g[0] ) * A[0] +
+                            ( pdata[3 * cellInd[j] + 1] - g[1] ) * A[1] +
+                            ( pdata[3 * cellInd[j] + 2] - g[2] ) * A[2] );
+      if ( maxDist < d )
+        maxDist = d;
+    }
+    isPlanar[c] = ( maxDist <= tolerance );
+    for ( int k = 0; k < 3; k++ )
+    {
+      cellNormal[3 * c + k] = A[k];
+      cellCenter[3 * c + k] = g[k];
+    }
+  }
+
+  //--- Index of a neighboring cell ( -1: empty )
+  auto neighborCell = [&]( long c, int dx, int dy, int dz ) -> long
+  {
+    long long x = (long long)( cellKey[c] >> ( 2 * PLANE_KEY_BITS ) ) + dx;
+    long long y = (long long)( ( cellKey[c] >> PLANE_KEY_BITS ) & keyMax ) + dy;
+    long long z = (long long)( cellKey[c] & keyMax ) + dz;
+    if ( x < 0 || y < 0 || z < 0 || x > keyMax || y > keyMax || z > keyMax )
+      return -1;
+    unsigned long long key = ( (unsigned long long)x << ( 2 * PLANE_KEY_BITS ) ) |
+                             ( (unsigned long long)y << PLANE_KEY_BITS ) | (unsigned long long)z;
+    std::vector<unsigned long long>::iterator it = std::lower_bound( cellKey.begin(), cellKey.end(), key );
+    if ( it == cellKey.end() || *it != key )
+      return -1;
+    return (long)( it - cellKey.begin() );
+  };
+
+  //--- Normals agree and each centroid lies on the other plane
+  auto isCoplanar = [&]( long a, long b ) -> bool
+  {
+    if ( !isPlanar[a] || !isPlanar[b] )
+      return false;
+    const double *na = &cellNormal[3 * a];
+    const double *nb = &cellNormal[3 * b];
+    if ( std::fabs( na[0] * nb[0] + na[1] * nb[1] + na[2] * nb[2] ) < PLANE_COS )
+      return false;
+    double dab = 0.0, dba = 0.0;
+    for ( int k = 0; k < 3; k++ )
+    {
+      dab += ( cellCenter[3 * b + k] - cellCenter[3 * a + k] ) * na[k];
+      dba += ( cellCenter[3 * a + k] - cellCenter[3 * b + k] ) * nb[k];
+    }
+    return ( std::fabs( dab ) <= 2.0 * tolerance && std::fabs( dba ) <= 2.0 * tolerance );
+  };
+
+  //--- Region growing
+  std::vector< std::atomic<size_t> > parent( numCell );
+  for ( long c = 0; c < numCell; c++ )
+    parent[c].store( c );
+
+#pragma omp parallel for schedule(dynamic, 64)
+  for ( long c = 0; c < numCell; c++ )
+  {
+    if ( !isPlanar[c] )
+      continue;
+    for ( int dx = -1; dx <= 1; dx++ )
+      for ( int dy = -1; dy <= 1; dy++ )
+        for ( int dz = -1; dz <= 1; dz++ )
+        {
+          long nb = neighborCell( c, dx, dy, dz );
+          if ( nb > c && isCoplanar( c, nb ) )
+            uniteRoots( parent, c, nb );
+        }
+  }
+
+  std::vector<size_t> regionCells( numCell, 0 );
+  long numPlanar = 0;
+  for ( long c = 0; c < numCell; c++ )
+  {
+    if ( isPlanar[c] )
+    {
+      regionCells[ findRoot( parent, c ) ]++;
+      numPlanar++;
+    }
+  }
+  long numRegion = 0;
+  for ( long c = 0; c < numCell; c++ )
+    if ( regionCells[c] >= (size_t)MIN_REGION_CELLS )
+      numRegion++;
+
+  //--- Interior cells
+  m_isPlaneInterior.assign( numVert, 0 );
+  size_t numInterior = 0;
+
+#pragma omp parallel for schedule(dynamic, 64) reduction(+:numInterior)
+  for ( long c = 0; c < numCell; c++ )
+  {
+    if ( !isPlanar[c] || regionCells[ findRoot( parent, c ) ] < (size_t)MIN_REGION_CELLS )
+      continue;
+    bool interior = true;
+    for ( int dx = -1; dx <= 1 && interior; dx++ )
+      for ( int dy = -1; dy <= 1 && interior; dy++ )
+        for ( int dz = -1; dz <= 1 && interior; dz++ )
+        {
+          long nb = neighborCell( c, dx, dy, dz );
+          if ( nb >= 0 && nb != c && !isCoplanar( c, nb ) )
+            interior = false;
+        }
+    if ( !interior )
+      continue;
+
+    for ( size_t j = cellStart[c]; j < cellStart[c + 1]; j++ )
+    {
+      size_t i = keys[j].second;
+      m_isPlaneInterior[i] = 1;
+      if ( m_isEstimateNormal )
+      {
+        double point[3] = { pdata[3 * i], pdata[3 * i + 1], pdata[3 * i + 2] };
+        storeNormal( m_normal, i, point, &cellNormal[3 * c], 1.0 );
+      }
+    }
+    numInterior += cellStart[c + 1] - cellStart[c];
+  }
+
+  std::cout << "Planar cells    : " << numPlanar << " / " << numCell << std::endl;
+  std::cout << "Planar regions  : " << numRegion << " ( >= " << MIN_REGION_CELLS << " cells )" << std::endl;
+  std::cout << "Interior points : " << numInterior << " ( "
+            << 100.0 * (double)numInterior / (double)numVert << " % ) are skipped" << std::endl;
+  std::cout << std::endl;
+}
+
+// --- Feature value from eigenvalues sorted as l1 >= l2 >= l3.
+double calculateFeature::eigenFeature( double l1, double l2, double l3 )
+{
+  double sum = l1 + l2 + l3;
+  double var = 0.0;
+
+  if ( sum < EPSILON )
+    return 0.0;
+
+  if ( m_feature_id == CHANGE_OF_CURVATURE_ID )
+    var = l3 / sum;
+  else if ( m_feature_id == APLANARITY_ID )
+    var = 1 - ( (l2 - l3) / l1 );
+  else if ( m_feature_id == LINEARITY_ID )
+    var = ( l1 - l2 ) / l1;
+  else if ( m_feature_id == EIGENTROPY_ID )
+  {
+    double lambda1 = l1 / sum;
+    double lambda2 = l2 / sum;
+    double lambda3 = l3 / sum;
+    var = -( lambda1 * log(lambda1) + lambda2 * log(lambda2) + lambda3 * log(lambda3) );
+
+    if ( isnan(var) )
+      var = 0.0;
+  }
+  else if ( m_feature_id == SUM_OF_EIGENVALUES_ID )
+    var = sum;
+  else if ( m_feature_id == PLANARITY_ID )
+    var = ( l2 - l3 ) / l1;
+
+  return var;
+}
+
+// --- A[0..2] is the eigenvector of the smallest eigenvalue ( dsyev_ with 'V' ).
+void calculateFeature::storeNormal( std::vector<float> &normal, size_t i,
+                                    const double point[3], const double A[], double sum )
+{
+  if ( sum < EPSILON )
+    return;
+
+  double nx = A[0], ny = A[1], nz = A[2];
+  double vx = m_viewpoint.x() - point[0];
+  double vy = m_viewpoint.y() - point[1];
+  double vz = m_viewpoint.z() - point[2];
+  if ( nx * vx + ny * vy + nz * vz < 0.0 )
+  {
+    nx = -nx; ny = -ny; nz = -nz;
+  }
+
+  normal[3 * i]     = nx;
+  normal[3 * i + 1] = ny;
+  normal[3 * i + 2] = nz;
+}
+
+// --- Feature kernels specialized per FeatureValueID.
+//     A kernel takes the covariance matrix C = { xx, yy, zz, xy, yz, zx } and computes only
+//     the quantities its feature needs; calcFeatureValues selects one kernel per run.
+typedef double (*FeatureKernel)( const double C[6] );
+
+//--- Smallest eigenvalue in closed form ( trigonometric solution of the characteristic cubic )
+static double covarianceMinEigenvalue( const double C[6] )
+{
+  double p1 = C[3] * C[3] + C[4] * C[4] + C[5] * C[5];
+  if ( p1 == 0.0 )
+    return std::min( C[0], std::min( C[1], C[2] ) );
+
+  double q  = ( C[0] + C[1] + C[2] ) / 3.0;
+  double p2 = ( C[0] - q ) * ( C[0] - q ) + ( C[1] - q ) * ( C[1] - q ) +
+              ( C[2] - q ) * ( C[2] - q ) + 2.0 * p1;
+  double p  = sqrt( p2 / 6.0 );
+
+  //--- B = ( C - qI ) / p,  r = det(B) / 2
+  double bxx = ( C[0] - q ) / p, byy = ( C[1] - q ) / p, bzz = ( C[2] - q ) / p;
+  double bxy = C[3] / p, byz = C[4] / p, bzx = C[5] / p;
+  double r = 0.5 * ( bxx * ( byy * bzz - byz * byz ) -
+                     bxy * ( bxy * bzz - byz * bzx ) +
+                     bzx * ( bxy * byz - byy * bzx ) );
+  r = std::max( -1.0, std::min( 1.0, r ) );
+
+  double phi = acos( r ) / 3.0;
+  double lmin = q + 2.0 * p * cos( phi + 2.0 * M_PI / 3.0 );
+  return std::max( lmin, 0.0 );
+}
+
+//--- Feature from the eigenvalues l1 >= l2 >= l3 ( sum > 0 )
+template <int FEATURE_ID> double eigenvalueFeature( double l1, double l2, double l3 );
+
+template <> double eigenvalueFeature<calculateFeature::APLANARITY_ID>( double l1, double l2, double l3 )
+{
+  return 1 - ( (l2 - l3) / l1 );
+}
+
+template <> double eigenvalueFeature<calculateFeature::LINEARITY_ID>( double l1, double l2, double /*l3*/ )
+{
+  return ( l1 - l2 ) / l1;
+}
 
-    // Caluculate Covariance matrix and EigenValues using KVS
-    //---- Covariance matrix
-    kvs::Matrix<double> M( 3, 3 );
-    M[0][0] = s_xx; M[0][1] = s_xy; M[0][2] = s_xz;
-    M[1][0] = s_yx; M[1][1] = s_yy; M[1][2] = s_yz;
-    M[2][0] = s_zx; M[2][1] = s_zy; M[2][2] = s_zz;
+template <> double eigenvalueFeature<calculateFeature::EIGENTROPY_ID>( double l1, double l2, double l3 )
+{
+  double sum = l1 + l2 + l3;
+  double lambda1 = l1 / sum;
+  double lambda2 = l2 / sum;
+  double lambda3 = l3 / sum;
+  double var = -( lambda1 * log(lambda1) + lambda2 * log(lambda2) + lambda3 * log(lambda3) );
+  if ( isnan(var) )
+    var = 0.0;
+  return var;
+}
 
-    //---- Calcuation of eigenvalues
-    kvs::EigenDecomposer<double> eigen( M );
-    const kvs::Vector<double>& L = eigen.eigenValues();
+template <> double eigenvalueFeature<calculateFeature::PLANARITY_ID>( double l1, double l2, double l3 )
+{
+  return ( l2 - l3 ) / l1;
+}
 
-    ***/
+//--- General kernel: all the eigenvalues
+template <int FEATURE_ID> double covarianceFeature( const double C[6] )
+{
+  double A[DIM * DIM];
+  double W[DIM];
+  covarianceEigen( C, 'N', A, W );
+  if ( W[0] + W[1] + W[2] < EPSILON )
+    return 0.0;
+  return eigenvalueFeature<FEATURE_ID>( W[2], W[1], W[0] );
+}
 
-    // Caluculate Covariance matrix and EigenValues using LAPACK
-    //--- Preparation for LAPACK
-    char jovz = 'V';
-    char uplo = 'U';
-    int n     = DIM;
-    double A[n*n];
-    double W[n];
-    int lwork = n*n;
-    double WORK[n*n];
-    int info;
+//--- Change of curvature: smallest eigenvalue and trace only
+template <> double covarianceFeature<calculateFeature::CHANGE_OF_CURVATURE_ID>( const double C[6] )
+{
+  double sum = C[0] + C[1] + C[2];
+  if ( sum < EPSILON )
+    return 0.0;
+  return covarianceMinEigenvalue( C ) / sum;
+}
 
-    //---- Covariance matrix
-    A[0] = s_xx; A[3] = s_xy; A[6] = s_zx;
-    A[1] = 0.0 ; A[4] = s_yy; A[7] = s_yz;
-    A[2] = 0.0 ; A[5] = 0.0 ; A[8] = s_zz;
+//--- Sum of eigenvalues: trace only
+template <> double covarianceFeature<calculateFeature::SUM_OF_EIGENVALUES_ID>( const double C[6] )
+{
+  double sum = C[0] + C[1] + C[2];
+  return ( sum < EPSILON ) ? 0.0 : sum;
+}
 
-    //---- Calcuation of eigenvalues and egenvectors
-    dsyev_( &jovz, &uplo, (__CLPK_integer *) &n, A, (__CLPK_integer *) &n,
-            W, WORK, (__CLPK_integer *) &lwork, (__CLPK_integer *) &info );
+//--- Dispatch table ( indexed by FeatureValueID )
+static const FeatureKernel FEATURE_KERNELS[] = {
+  covarianceFeature<calculateFeature::CHANGE_OF_CURVATURE_ID>,
+  covarianceFeature<calculateFeature::APLANARITY_ID>,
+  covarianceFeature<calculateFeature::LINEARITY_ID>,
+  covarianceFeature<calculateFeature::EIGENTROPY_ID>,
+  covarianceFeature<calculateFeature::SUM_OF_EIGENVALUES_ID>,
+  covarianceFeature<calculateFeature::PLANARITY_ID>
+};
+
+void calculateFeature::calcFeatureValues( kvs::PolygonObject* ply, double radius,
+                                          std::vector<float> &featureValues )
+{
 
+  ply->updateMinMaxCoords();
+  kvs::ValueArray<kvs::Real32> coords = ply->coords();
+  float *pdata = coords.data();
+  size_t numVert = ply->numberOfVertices();
+  kvs::Vector3f minBB = ply->minObjectCoord();
+  kvs::Vector3f maxBB = ply->maxObjectCoord();
 
-    eigenValues.push_back( W[2] );
-    eigenValues.push_back( W[1] );
-    eigenValues.push_back( W[0] );
+  double *mrange = new double[6];
+  mrange[0] = (double)minBB.x();
+  mrange[1] = (double)maxBB.x();
+  mrange[2] = (double)minBB.y();
+  mrange[3] = (double)maxBB.y();
+  mrange[4] = (double)minBB.z();
+  mrange[5] = (double)maxBB.z();
 
-    if (!((i + 1) % INTERVAL))
-      std::cout << i + 1 << ", " << n0 << " EigenValues: ( " << eigenValues[0] << ", "  << eigenValues[1] << ", " << eigenValues[2] << " )" << std::endl;
+  // create octree
+  std::cout << "Creating Octree... (Number of Vertex : " << numVert << std::endl;
+  std::cout << minBB << " \n"
+            << maxBB << std::endl;
+  octree *myTree = new octree( pdata, numVert, mrange, MIN_NODE );
 
+  double sigMax = 0.0;
+
+  size_t numQuery = m_previewIndex.empty() ? numVert : m_previewIndex.size();
+  FeatureKernel kernel = FEATURE_KERNELS[m_feature_id];
+  featureValues.assign( numQuery, 0.0f );
+
+  //--- Eigenvalues and neighbor counts for the feature expression ( evaluated after the search )
+  std::vector<double> exprL1, exprL2, exprL3, exprN;
+  if ( m_expression != NULL )
+  {
+    std::cout << "Feature expression : " << m_expression->text() << std::endl;
+    exprL1.resize( numQuery );
+    exprL2.resize( numQuery );
+    exprL3.resize( numQuery );
+    exprN.resize( numQuery );
   }
 
-  return eigenValues;
-}
\ No newline at end of file
+  std::cout << "Start OCtree Search..... " << std::endl;
+#pragma omp parallel
+  {
+    vector<size_t> nearInd;
+    vector<double> dist;
+    NeighborBuffer buf;
+
+#pragma omp for schedule(dynamic, 256) reduction(max:sigMax)
+    for ( long q = 0; q < (long)numQuery; q++ )
+    {
+      size_t i = m_previewIndex.empty() ? q : m_previewIndex[q];
+      if ( !m_isPlaneInterior.empty() && m_isPlaneInterior[i] )
+        continue;
+      double point[3] = { coords[3 * i],
+                          coords[3 * i + 1],
+                          coords[3 * i + 2] };
+
+      nearInd.clear();
+      dist.clear();
+      search_points( point, radius, pdata, myTree->octreeRoot, &nearInd, &dist );
+      //--- Neighbors in the point order: the sums do not depend on the octree,
+      //    so that a tile ( out-of-core, shards ) gives the same features as in-core
+      std::sort( nearInd.begin(), nearInd.end() );
+      int n0 = (int)nearInd.size();
+
+      //--- Covariance matrix ( xx, yy, zz, xy, yz, zx ) of the gathered neighbors
+      double mean[3];
+      double C[6];
+      gatherNeighbors( pdata, nearInd, buf, mean );
+      gatheredCovariance( buf, mean, C );
+      double var;
+
+      if ( m_isEstimateNormal )
+      {
+        //--- Eigenvectors are needed for the normal
+        double A[DIM * DIM];
+        double W[DIM];
+        covarianceEigen( C, 'V', A, W );
+        storeNormal( m_normal, i, point, A, W[0] + W[1] + W[2] );
+        var = eigenFeature( W[2], W[1], W[0] );
+        if ( m_expression != NULL )
+        {
+          exprL1[q] = W[2]; exprL2[q] = W[1]; exprL3[q] = W[0];
+        }
+      }
+      else if ( m_expression != NULL )
+      {
+        double A[DIM * DIM];
+        double W[DIM];
+        covarianceEigen( C, 'N', A, W );
+        exprL1[q] = W[2]; exprL2[q] = W[1]; exprL3[q] = W[0];
+        var = 0.0;
+      }
+      else
+        var = kernel( C );
+      if ( m_expression != NULL )
+        exprN[q] = n0;
+
+      //--- Contributing rate of 3rd(minimum) component
+      featureValues[q] = var;
+      if ( sigMax < var )
+        sigMax = var;
+
+      if ( !((i + 1) % INTERVAL) )
+        std::cout << i + 1 << ", " << n0 << ": " << var << std::endl;
+    }
+  }
+
+  //--- Feature expression over batches of points
+  if ( m_expression != NULL )
+  {
+    sigMax = 0.0;
+    std::vector<double> exprR( EXPRESSION_BATCH, radius );
+    std::vector<double> exprOut( EXPRESSION_BATCH );
+    for ( size_t begin = 0; begin < numQuery; begin += EXPRESSION_BATCH )
+    {
+      size_t count = std::min( EXPRESSION_BATCH, numQuery - begin );
+      m_expression->evaluate( &exprL1[begin], &exprL2[begin], &exprL3[begin], &exprN[begin],
+                              &exprR[0], &exprOut[0], count );
+      for ( size_t b = 0; b < count; b++ )
+      {
+        featureValues[begin + b] = exprOut[b];
+        if ( sigMax < exprOut[b] )
+          sigMax = exprOut[b];
+      }
+    }
+  }
+
+  m_maxFeature = 1.0;
+  m_rawMaxFeature = sigMax;
+  std::cout << "Maximun of Sigma : " << sigMax << std::endl;
+
+  delete myTree;
+  delete [] mrange;
+
+  // Normalize feature values ( in place )
+  if ( m_isNormalize )
+    for ( size_t q = 0; q < numQuery; q++ )
+      featureValues[q] = featureValues[q] / sigMax;
+}
+
+//--- Feature values of the eigenvalues ( l1, l2, l3 per point ) and the neighbor counts
+void calculateFeature::calcFeatureFromEigenValues( const std::vector<double> &eigenValues,
+                                                   const std::vector<double> &neighbors,
+                                                   double radius, std::vector<float> &ft )
+{
+  size_t numVert = neighbors.size();
+  ft.assign( numVert, 0.0f );
+  double sigMax = 0.0;
+
+  if ( m_expression != NULL )
+  {
+    std::cout << "Feature expression : " << m_expression->text() << std::endl;
+    std::vector<double> exprL1( EXPRESSION_BATCH ), exprL2( EXPRESSION_BATCH ), exprL3( EXPRESSION_BATCH );
+    std::vector<double> exprR( EXPRESSION_BATCH, radius );
+    std::vector<double> exprOut( EXPRESSION_BATCH );
+    for ( size_t begin = 0; begin < numVert; begin += EXPRESSION_BATCH )
+    {
+      size_t count = std::min( EXPRESSION_BATCH, numVert - begin );
+      for ( size_t b = 0; b < count; b++ )
+      {
+        exprL1[b] = eigenValues[3 * ( begin + b )];
+        exprL2[b] = eigenValues[3 * ( begin + b ) + 1];
+        exprL3[b] = eigenValues[3 * ( begin + b ) + 2];
+      }
+      m_expression->evaluate( &exprL1[0], &exprL2[0], &exprL3[0], &neighbors[begin],
+                              &exprR[0], &exprOut[0], count );
+      for ( size_t b = 0; b < count; b++ )
+      {
+        ft[begin + b] = exprOut[b];
+        if ( sigMax < exprOut[b] )
+          sigMax = exprOut[b];
+      }
+    }
+  }
+  else
+  {
+#pragma omp parallel for reduction(max:sigMax)
+    for ( long i = 0; i < (long)numVert; i++ )
+    {
+      double var = eigenFeature( eigenValues[3 * i], eigenValues[3 * i + 1], eigenValues[3 * i + 2] );
+      ft[i] = var;
+      if ( sigMax < var )
+        sigMax = var;
+    }
+  }
+
+  m_maxFeature = 1.0;
+  m_rawMaxFeature = sigMax;
+  std::cout << "Maximun of Sigma : " << sigMax << std::endl;
+
+  // Normalize feature values ( in place )
+  if ( m_isNormalize )
+    for ( size_t i = 0; i < numVert; i++ )
+      ft[i] = ft[i] / sigMax;
+}
+
+void calculateFeature::calcEigenValues( kvs::PolygonObject* ply, double radius,
+                                        std::vector<double> &eigenValues,
+                                        std::vector<float> *normal,
+                                        std::vector<double> *neighbors )
+{
+  ply->updateMinMaxCoords();
+  kvs::ValueArray<kvs::Real32> coords = ply->coords();
+  float *pdata = coords.data();
+  size_t numVert = ply->numberOfVertices();
+  kvs::Vector3f minBB = ply->minObjectCoord();
+  kvs::Vector3f maxBB = ply->maxObjectCoord();
+
+  //--- Cached eigenvalues of the same points and radius ( normals are not cached )
+  std::vector<double> counts;
+  if ( m_eigenCache != NULL )
+  {
+    m_eigenCache->setContent( pdata, numVert );
+    if ( normal == NULL && m_eigenCache->read( radius, eigenValues, counts ) )
+    {
+      if ( neighbors != NULL )
+        neighbors->swap( counts );
+      return;
+    }
+  }
+
+  double *mrange = new double[6];
+  mrange[0] = (double)minBB.x();
+  mrange[1] = (double)maxBB.x();
+  mrange[2] = (double)minBB.y();
+  mrange[3] = (double)maxBB.y();
+  mrange[4] = (double)minBB.z();
+  mrange[5] = (double)maxBB.z();
+
+  // create octree
+  std::cout << "Creating Octree... (Number of Vertex : " << numVert << std::endl;
+  std::cout << minBB << " \n"
+            << maxBB << std::endl;
+  octree *myTree = new octree( pdata, numVert, mrange, MIN_NODE );
+
+  eigenValues.assign( 3 * numVert, 0.0 );
+  counts.assign( numVert, 0.0 );
+  if ( normal != NULL )
+    normal->assign( 3 * numVert, 0.0f );
+  char jobz = ( normal != NULL ) ? 'V' : 'N';
+
+  std::cout << "Start OCtree Search..... " << std::endl;
+#pragma omp parallel
+  {
+    vector<size_t> nearInd;
+    vector<double> dist;
+    NeighborBuffer buf;
+
+#pragma omp for schedule(dynamic, 256)
+    for ( long i = 0; i < (long)numVert; i++ )
+    {
+      double point[3] = { coords[3 * i],
+                          coords[3 * i + 1],
+                          coords[3 * i + 2] };
+
+      nearInd.clear();
+      dist.clear();
+      search_points( point, radius, pdata, myTree->octreeRoot, &nearInd, &dist );
+      std::sort( nearInd.begin(), nearInd.end() );
+      int n0 = (int)nearInd.size();
+
+      //--- Covariance matrix and its eigenvalues ( LAPACK, W[0] <= W[1] <= W[2] )
+      double mean[3];
+      double C[6];
+      double A[DIM * DIM];
+      double W[DIM];
+      gatherNeighbors( pdata, nearInd, buf, mean );
+      gatheredCovariance( buf, mean, C );
+      covarianceEigen( C, jobz, A, W );
+
+      eigenValues[3 * i]     = W[2];
+      eigenValues[3 * i + 1] = W[1];
+      eigenValues[3 * i + 2] = W[0];
+      counts[i] = n0;
+
+      if ( normal != NULL )
+        storeNormal( *normal, i, point, A, W[0] + W[1] + W[2] );
+
+      if (!((i + 1) % INTERVAL))
+        std::cout << i + 1 << ", " << n0 << " EigenValues: ( " << W[2] << ", "  << W[1] << ", " << W[0] << " )" << std::endl;
+    }
+  }
+
+  delete myTree;
+  delete [] mrange;
+
+  if ( m_eigenCache != NULL )
+    m_eigenCache->write( radius, eigenValues, counts );
+  if ( neighbors != NULL )
+    neighbors->swap( counts );
+}
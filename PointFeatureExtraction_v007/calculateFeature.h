@@ -3,6 +3,9 @@
 
 #include <kvs/PolygonObject>
 #include <vector>
+#include "featureExpression.h"
+#include "eigenCache.h"
+#include "featureCheckpoint.h"
 
 class calculateFeature
 {
@@ -14,7 +17,11 @@ public:
     MinimumEntropyFeature = 1,
     NormalPCA             = 2,
     NormalDispersion      = 3,
-    PlaneBasedFeature     = 4
+    PlaneBasedFeature     = 4,
+    MultiScaleFeature     = 5,
+    AdaptiveRadiusFeature = 6,
+    CoarseToFineFeature   = 7,
+    MeshDihedralFeature   = 8
   };
 
   enum FeatureValueID
@@ -34,10 +41,29 @@ public:
                     const double distance,
                     kvs::PolygonObject *ply );
 
-  std::vector<float> feature( void ) { return m_feature; }
+  const std::vector<float>& feature( void ) { return m_feature; }
+  std::vector<float> releaseFeature( void ) { return std::move( m_feature ); }
   void setFeatureType( FeatureType type );
   void setFeatureValueID( FeatureValueID id );
   void addNoise( double noise );
+  void setNormalEstimation( bool flag,
+                            kvs::Vector3f viewpoint = kvs::Vector3f( 0.0, 0.0, 0.0 ) );
+  void setPlaneSegmentation( bool flag );
+  void setAutoSearchRadius( bool flag );
+  void setPreviewPoints( const std::vector<size_t> &index );
+  void setFeatureExpression( featureExpression *expression );
+  void setIncremental( const std::vector<float> &oldFeature,
+                       double oldRadius = 0.0, int oldFeatureValueID = -1,
+                       double oldRawMax = 0.0 );
+  void setEigenCache( eigenCache *cache );
+  void setCheckpoint( featureCheckpoint *checkpoint );
+  void setFixedSearchRadius( bool flag );
+  void setNormalization( bool flag );
+  void setRegionOfInterest( kvs::Vector3f roiMin, kvs::Vector3f roiMax );
+  void setRegionOfInterest( const std::vector<size_t> &index );
+  bool isRegionOfInterest( void ) { return m_isRegionOfInterest; }
+  const std::vector<size_t>& roiIndex( void ) { return m_roiIndex; }
+  bool isPreview( void ) { return !m_previewIndex.empty(); }
   void setSearchRadius( double distance );
   void setSearchRadius( double divide,
 			                  kvs::Vector3f bbmin,
@@ -48,6 +74,16 @@ public:
   void calc( kvs::PolygonObject *ply );
   double maxFeature( void ) { return m_maxFeature; }
   double minFeature( void ) { return m_minFeature; }
+  double rawMaxFeature( void ) { return m_rawMaxFeature; }
+  double searchRadius( void ) { return m_searchRadius; }
+  FeatureValueID featureValueID( void ) { return m_feature_id; }
+  featureExpression* expression( void ) { return m_expression; }
+  const std::vector<float>& multiScaleFeature( void ) { return m_multiScaleFeature; }
+  std::vector<float> releaseMultiScaleFeature( void ) { return std::move( m_multiScaleFeature ); }
+  std::vector<double> scaleRadii( void ) { return m_scaleRadii; }
+  int numberOfScales( void ) { return (int)m_scaleRadii.size(); }
+  const std::vector<float>& estimatedNormal( void ) { return m_normal; }
+  std::vector<float> releaseEstimatedNormal( void ) { return std::move( m_normal ); }
 
 private:
   size_t m_number;
@@ -59,17 +95,66 @@ private:
   double m_searchRadius;
   double m_maxFeature;
   double m_minFeature;
+  std::vector<float> m_multiScaleFeature; // K features per point ( point-major )
+  std::vector<double> m_scaleRadii;       // Radius of each channel
+  bool m_isEstimateNormal;
+  kvs::Vector3f m_viewpoint;
+  std::vector<float> m_normal;            // PCA normals ( 3 per point )
+  bool m_isPlaneSegmentation;
+  std::vector<char> m_isPlaneInterior;    // 1: inside a large planar region ( feature 0 )
+  bool m_isAutoRadius;
+  double m_pointSpacing;                  // Nominal point spacing ( measured )
+  double m_autoRadius;                    // Recommended local-area radius
+  double m_autoMinRadius;                 // Recommended radius range
+  double m_autoMaxRadius;
+  std::vector<size_t> m_previewIndex;     // Points whose features are computed in preview ( empty: all )
+  featureExpression *m_expression;        // User-defined feature value ( NULL: FeatureValueID )
+  std::vector<float> m_oldFeature;        // Features of the old points in incremental mode ( empty: off )
+  double m_oldRadius;                     // Radius of the previous run ( 0: unknown )
+  int m_oldFeatureValueID;                // Feature value type of the previous run ( -1: unknown )
+  double m_oldRawMax;                     // Maximum before the normalization of the previous run ( 0: unknown )
+  bool m_isRegionOfInterest;
+  bool m_isRoiBox;                        // true: ROI box, false: ROI index list
+  kvs::Vector3f m_roiMin;
+  kvs::Vector3f m_roiMax;
+  std::vector<size_t> m_roiIndex;         // ROI points in the input cloud
+  eigenCache *m_eigenCache;               // Eigenvalues saved per radius ( NULL: off )
+  featureCheckpoint *m_checkpoint;        // State saved per completed radius ( NULL: off )
+  bool m_isFixedRadius;                   // Radius of setSearchRadius() ( no prompt )
+  bool m_isNormalize;
+  double m_rawMaxFeature;                 // Maximum before the normalization ( Point PCA )
 
  private:
    void calcPointPCA( kvs::PolygonObject *ply );
-   void calcNormalPCA( kvs::PolygonObject *ply, std::vector<float> &normal );
-   void calcNormalDispersion( kvs::PolygonObject *ply, std::vector<float> &normal );
+   void calcNormalPCA( kvs::PolygonObject *ply, const float *normal );
+   void calcNormalDispersion( kvs::PolygonObject *ply, const float *normal );
 
    void calcMinimumEntropyFeature( kvs::PolygonObject *ply );
    void calcPlaneBasedFeature( kvs::PolygonObject *ply );
+   void calcMultiScaleFeature( kvs::PolygonObject *ply );
+   void calcAdaptiveRadiusFeature( kvs::PolygonObject *ply );
+   void calcCoarseToFineFeature( kvs::PolygonObject *ply );
+   void calcPlaneSegmentation( kvs::PolygonObject *ply );
+   void calcMeshDihedralFeature( kvs::PolygonObject *ply );
+   void calcIncrementalFeature( kvs::PolygonObject *ply );
+   kvs::PolygonObject* cropRegionOfInterest( kvs::PolygonObject *ply );
+   void estimateSearchRadius( kvs::PolygonObject *ply );
+   void inputMinMaxSearchRadius( kvs::PolygonObject *ply, double &minRadius, double &maxRadius );
 
-   std::vector<float> calcFeatureValues( kvs::PolygonObject *ply, double radius );
-   std::vector<double> calcEigenValues( kvs::PolygonObject *ply, double radius );
+   double eigenFeature( double l1, double l2, double l3 );
+   void calcNeighborEigen( const float *coords, const std::vector<size_t> &nearInd,
+                           char jobz, double A[], double W[] );
+   void storeNormal( std::vector<float> &normal, size_t i,
+                     const double point[3], const double A[], double sum );
+
+   void calcFeatureValues( kvs::PolygonObject *ply, double radius, std::vector<float> &ft );
+   void calcEigenValues( kvs::PolygonObject *ply, double radius,
+                         std::vector<double> &eigenValues,
+                         std::vector<float> *normal = NULL,
+                         std::vector<double> *neighbors = NULL );
+   void calcFeatureFromEigenValues( const std::vector<double> &eigenValues,
+                                    const std::vector<double> &neighbors,
+                                    double radius, std::vector<float> &ft );
 
 
 };
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <vector>
 #include <cmath>
+#include <algorithm>
 #include "create_octree.h"
 #include "vec_ops.h"
 
@@ -145,6 +146,19 @@ void create_octree(octreeNode *node, float points[], int nMin,
   return;
 }
 
+// Free a node and its children ( a node with points is a leaf )
+void delete_octree(octreeNode *node) {
+
+  if (node->pInd.size() == 0) {
+    for (int i = 0; i < 2; i++)
+      for (int j = 0; j < 2; j++)
+	for (int k = 0; k < 2; k++)
+	  if (node->cOctreeNode[i][j][k] != NULL)
+	    delete_octree(node->cOctreeNode[i][j][k]);
+  }
+  delete node;
+}
+
 
 void search_node(double p[], double R2, octreeNode *node, float points[],
 		 double xleft, double xright, double yleft, double yright,
@@ -303,3 +317,112 @@ void search_points(double p[], double R, float points[],
 
   return;
 }
+
+
+typedef std::pair<double, size_t> distIndex;
+
+// Squared distance from p to the box [xMin, xMax]x[yMin, yMax]x[zMin, zMax]
+static double box_dist2(double p[], double xMin, double xMax, double yMin, double yMax,
+			double zMin, double zMax) {
+  double dx = (p[0] < xMin) ? xMin - p[0] : ((p[0] > xMax) ? p[0] - xMax : 0.0);
+  double dy = (p[1] < yMin) ? yMin - p[1] : ((p[1] > yMax) ? p[1] - yMax : 0.0);
+  double dz = (p[2] < zMin) ? zMin - p[2] : ((p[2] > zMax) ? p[2] - zMax : 0.0);
+  return dx * dx + dy * dy + dz * dz;
+}
+
+// Keep the k nearest points in a max-heap; R2 shrinks to the k-th distance
+void search_nearest_node(double p[], size_t k, octreeNode *node, float points[],
+			 double xMin, double xMax, double yMin, double yMax,
+			 double zMin, double zMax,
+			 std::vector<distIndex> *heap, double *R2) {
+
+  size_t i, j, l, pNum;
+
+  if (node->pInd.size() == 0) {
+    // If node has children, visit them from the nearest one
+    double d2[8];
+    int order[8];
+    int nChild = 0;
+    for (i = 0; i < 2; i++) {
+      for (j = 0; j < 2; j++) {
+	for (l = 0; l < 2; l++) {
+	  if (node->cOctreeNode[i][j][l] == NULL) continue;
+	  double cd2 = box_dist2(p,
+				 (i ? node->c[0] : xMin), (i ? xMax : node->c[0]),
+				 (j ? node->c[1] : yMin), (j ? yMax : node->c[1]),
+				 (l ? node->c[2] : zMin), (l ? zMax : node->c[2]));
+	  int n = nChild++;
+	  while (n > 0 && d2[n - 1] > cd2) {
+	    d2[n] = d2[n - 1];
+	    order[n] = order[n - 1];
+	    n--;
+	  }
+	  d2[n] = cd2;
+	  order[n] = (int)(i * 4 + j * 2 + l);
+	}
+      }
+    }
+
+    for (int n = 0; n < nChild; n++) {
+      if (d2[n] >= *R2) break;
+      i = order[n] / 4;
+      j = (order[n] / 2) % 2;
+      l = order[n] % 2;
+      search_nearest_node(p, k, node->cOctreeNode[i][j][l], points,
+			  (i ? node->c[0] : xMin), (i ? xMax : node->c[0]),
+			  (j ? node->c[1] : yMin), (j ? yMax : node->c[1]),
+			  (l ? node->c[2] : zMin), (l ? zMax : node->c[2]),
+			  heap, R2);
+    }
+  }
+
+  else {
+    // If node is a leaf
+    pNum = node->pInd.size();
+    for (i = 0; i < pNum; i++) {
+      double pt[3] = { (double)points[node->pInd[i] * 3],
+                       (double)points[node->pInd[i] * 3 + 1],
+                       (double)points[node->pInd[i] * 3 + 2] };
+      double d0 = dist2( p, pt );
+      if( d0 < *R2 ) {
+	heap->push_back(distIndex(d0, node->pInd[i]));
+	std::push_heap(heap->begin(), heap->end());
+	if (heap->size() > k) {
+	  std::pop_heap(heap->begin(), heap->end());
+	  heap->pop_back();
+	}
+	if (heap->size() == k)
+	  *R2 = heap->front().first;
+      }
+    }
+  }
+
+  return;
+}
+
+
+// k nearest points within R, sorted by distance.
+// range[] is the bounding box given to the octree constructor.
+void search_nearest_points(double p[], size_t k, double R, float points[],
+			   octreeNode *node, double range[],
+			   std::vector<size_t> *nearIndPtr,
+			   std::vector<double> *dist) {
+
+  std::vector<distIndex> heap;
+  double R2 = R * R;
+
+  if (k == 0) return;
+  heap.reserve(k + 1);
+
+  search_nearest_node(p, k, node, points,
+		      range[0], range[1], range[2], range[3], range[4], range[5],
+		      &heap, &R2);
+
+  std::sort_heap(heap.begin(), heap.end());
+  for (size_t i = 0; i < heap.size(); i++) {
+    nearIndPtr->push_back(heap[i].second);
+    dist->push_back(sqrt(heap[i].first));
+  }
+
+  return;
+}
@@ -14,8 +14,15 @@ void create_octree(octreeNode *node, float points[], int nMin,
 		   double xMin, double xMax, double yMin, double yMax,
 		   double zMin, double zMax);
 
+void delete_octree(octreeNode *node);
+
 void search_points(double p[], double R, float points[],
                    octreeNode *Node, vector<size_t> *nearIndPtr,
                    vector<double> *dist );
 
+void search_nearest_points(double p[], size_t k, double R, float points[],
+                           octreeNode *Node, double range[],
+                           vector<size_t> *nearIndPtr,
+                           vector<double> *dist );
+
 #endif
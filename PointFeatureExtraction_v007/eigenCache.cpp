@@ -0,0 +1,154 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+#include "eigenCache.h"
+
+const char EIGEN_CACHE[]         = "#/PFE_EigenCache";
+const char EIGEN_NUM_PARTICLES[] = "#/NumParticles";
+const char EIGEN_CONTENT_HASH[]  = "#/ContentHash";
+const char EIGEN_RADIUS[]        = "#/Radius";
+const char EIGEN_END_HEADER[]    = "#/EndHeader";
+const char EIGEN_EXTENSION[]     = ".eig";
+const size_t EIGEN_CHUNK = 65536;   // Tuples per read / write
+
+const unsigned long long FNV_OFFSET = 14695981039346656037ULL;
+const unsigned long long FNV_PRIME  = 1099511628211ULL;
+
+//--- Radius as written to the header ( exact round trip of the double )
+static std::string radiusText( double radius )
+{
+  char buf[64];
+  snprintf( buf, sizeof(buf), "%.17g", radius );
+  return std::string( buf );
+}
+
+static std::string hashText( unsigned long long hash )
+{
+  char buf[32];
+  snprintf( buf, sizeof(buf), "%016llx", hash );
+  return std::string( buf );
+}
+
+eigenCache::eigenCache( const char* directory ):
+  m_directory( directory ),
+  m_number( 0 ),
+  m_contentHash( FNV_OFFSET )
+{  }
+
+//--- One 32-bit word per step
+unsigned long long coordinateHash( const float *coords, size_t num )
+{
+  unsigned long long hash = FNV_OFFSET;
+  for( size_t i = 0; i < 3 * num; i++ ) {
+    unsigned int word;
+    memcpy( &word, coords + i, sizeof(word) );
+    hash = ( hash ^ word ) * FNV_PRIME;
+  }
+  return ( hash ^ num ) * FNV_PRIME;
+}
+
+void eigenCache::setContent( const float *coords, size_t num )
+{
+  m_number = num;
+  m_contentHash = coordinateHash( coords, num );
+}
+
+std::string eigenCache::fileName( double radius )
+{
+  char buf[64];
+  snprintf( buf, sizeof(buf), "_%.9g", radius );
+  std::string name( m_directory );
+  if( !name.empty() && name[name.size() - 1] != '/' )
+    name += "/";
+  return name + hashText( m_contentHash ) + buf + EIGEN_EXTENSION;
+}
+
+//--- false: no cache for this key ( or a broken file )
+bool eigenCache::read( double radius, std::vector<double> &eigenValues, std::vector<double> &neighbors )
+{
+  std::string filename = fileName( radius );
+  std::ifstream fin( filename.c_str(), std::ios::binary );
+  if( !fin )
+    return false;
+
+  std::string line;
+  std::string hash, rad;
+  size_t num = 0;
+  bool isCache = false;
+  while( std::getline( fin, line ) ) {
+    std::istringstream words( line );
+    std::string command;
+    words >> command;
+    if( command == EIGEN_CACHE )               isCache = true;
+    else if( command == EIGEN_NUM_PARTICLES )  words >> num;
+    else if( command == EIGEN_CONTENT_HASH )   words >> hash;
+    else if( command == EIGEN_RADIUS )         words >> rad;
+    else if( command == EIGEN_END_HEADER )     break;
+    else                                       return false;
+  }
+  if( !isCache || num != m_number || hash != hashText( m_contentHash ) || rad != radiusText( radius ) )
+    return false;
+
+  //--- Tuples in one sequential pass
+  eigenValues.resize( 3 * num );
+  neighbors.resize( num );
+  std::vector<double> tuples( 4 * EIGEN_CHUNK );
+  for( size_t begin = 0; begin < num; begin += EIGEN_CHUNK ) {
+    size_t count = std::min( EIGEN_CHUNK, num - begin );
+    if( !fin.read( (char*)&tuples[0], sizeof(double) * 4 * count ) ) {
+      std::cout << "Eigenvalue cache is broken: " << filename << std::endl;
+      return false;
+    }
+    for( size_t k = 0; k < count; k++ ) {
+      eigenValues[3 * ( begin + k )]     = tuples[4 * k];
+      eigenValues[3 * ( begin + k ) + 1] = tuples[4 * k + 1];
+      eigenValues[3 * ( begin + k ) + 2] = tuples[4 * k + 2];
+      neighbors[begin + k]               = tuples[4 * k + 3];
+    }
+  }
+
+  std::cout << "Eigenvalue cache is loaded: " << filename << std::endl;
+  return true;
+}
+
+//--- Written to a temporary file and renamed, so that a partial file is never read
+void eigenCache::write( double radius, const std::vector<double> &eigenValues, const std::vector<double> &neighbors )
+{
+  std::string filename = fileName( radius );
+  std::string tmpname  = filename + ".tmp";
+  std::ofstream fout( tmpname.c_str(), std::ios::binary );
+  if( !fout ) {
+    std::cout << "Cannot write the eigenvalue cache: " << filename << std::endl;
+    return;
+  }
+
+  fout << EIGEN_CACHE << std::endl;
+  fout << EIGEN_NUM_PARTICLES << "  " << m_number << std::endl;
+  fout << EIGEN_CONTENT_HASH << "  " << hashText( m_contentHash ) << std::endl;
+  fout << EIGEN_RADIUS << "  " << radiusText( radius ) << std::endl;
+  fout << EIGEN_END_HEADER << std::endl;
+
+  std::vector<double> tuples( 4 * EIGEN_CHUNK );
+  for( size_t begin = 0; begin < m_number; begin += EIGEN_CHUNK ) {
+    size_t count = std::min( EIGEN_CHUNK, m_number - begin );
+    for( size_t k = 0; k < count; k++ ) {
+      tuples[4 * k]     = eigenValues[3 * ( begin + k )];
+      tuples[4 * k + 1] = eigenValues[3 * ( begin + k ) + 1];
+      tuples[4 * k + 2] = eigenValues[3 * ( begin + k ) + 2];
+      tuples[4 * k + 3] = neighbors[begin + k];
+    }
+    fout.write( (char*)&tuples[0], sizeof(double) * 4 * count );
+  }
+  fout.close();
+
+  if( !fout || std::rename( tmpname.c_str(), filename.c_str() ) != 0 ) {
+    std::cout << "Cannot write the eigenvalue cache: " << filename << std::endl;
+    std::remove( tmpname.c_str() );
+    return;
+  }
+  std::cout << "Eigenvalue cache is saved: " << filename << std::endl;
+}
@@ -0,0 +1,32 @@
+#ifndef _eigenCache_H__
+#define _eigenCache_H__
+
+#include <vector>
+#include <string>
+
+//--- FNV-1a hash of the coordinates ( 3 * num floats )
+unsigned long long coordinateHash( const float *coords, size_t num );
+
+//--- Cache of the per-point eigenvalues ( l1 >= l2 >= l3 ) and neighbor counts n0
+//    One file per ( point cloud, local-area radius ) in the cache directory.
+//    The key is a hash of the loaded coordinates and the radius, so that a later run
+//    with another feature value ID or expression reads the tuples back instead of
+//    searching the neighbors again.
+//    File: text header ( #/... ) followed by N tuples ( l1, l2, l3, n0 ) of doubles.
+class eigenCache {
+
+ public:
+  eigenCache( const char* directory );
+
+  void setContent( const float *coords, size_t num );
+  std::string fileName( double radius );
+  bool read( double radius, std::vector<double> &eigenValues, std::vector<double> &neighbors );
+  void write( double radius, const std::vector<double> &eigenValues, const std::vector<double> &neighbors );
+
+ private:
+  std::string m_directory;
+  size_t m_number;
+  unsigned long long m_contentHash;   // FNV-1a of the coordinates
+};
+
+#endif
@@ -0,0 +1,107 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+
+#include "featureCheckpoint.h"
+
+const char CHECKPOINT[]             = "#/PFE_Checkpoint";
+const char CHECKPOINT_KEY[]         = "#/Key";
+const char CHECKPOINT_STEP[]        = "#/CompletedSteps";
+const char CHECKPOINT_ARRAY_SIZES[] = "#/ArraySizes";
+const char CHECKPOINT_END_HEADER[]  = "#/EndHeader";
+
+featureCheckpoint::featureCheckpoint( const char* filename ):
+  m_filename( filename )
+{  }
+
+void featureCheckpoint::setKey( const std::string &key )
+{
+  m_key = key;
+}
+
+//--- false: no checkpoint of this run ( the arrays are not changed )
+bool featureCheckpoint::read( int &step, std::vector< std::vector<float>* > &arrays )
+{
+  std::ifstream fin( m_filename.c_str(), std::ios::binary );
+  if( !fin )
+    return false;
+
+  std::string line, key;
+  std::vector<size_t> sizes;
+  int completed = -1;
+  bool isCheckpoint = false;
+  while( std::getline( fin, line ) ) {
+    std::istringstream words( line );
+    std::string command;
+    words >> command;
+    if( command == CHECKPOINT )
+      isCheckpoint = true;
+    else if( command == CHECKPOINT_KEY )
+      std::getline( words >> std::ws, key );
+    else if( command == CHECKPOINT_STEP )
+      words >> completed;
+    else if( command == CHECKPOINT_ARRAY_SIZES ) {
+      size_t size;
+      while( words >> size )
+        sizes.push_back( size );
+    }
+    else if( command == CHECKPOINT_END_HEADER )
+      break;
+    else
+      return false;
+  }
+  if( !isCheckpoint || key != m_key || completed < 0 || sizes.size() != arrays.size() ) {
+    std::cout << "Checkpoint of another run is ignored: " << m_filename << std::endl;
+    return false;
+  }
+
+  std::vector< std::vector<float> > values( arrays.size() );
+  for( size_t a = 0; a < arrays.size(); a++ ) {
+    values[a].resize( sizes[a] );
+    if( sizes[a] > 0 && !fin.read( (char*)&values[a][0], sizeof(float) * sizes[a] ) ) {
+      std::cout << "Checkpoint is broken: " << m_filename << std::endl;
+      return false;
+    }
+  }
+  for( size_t a = 0; a < arrays.size(); a++ )
+    arrays[a]->swap( values[a] );
+  step = completed;
+  return true;
+}
+
+void featureCheckpoint::write( int step, const std::vector< std::vector<float>* > &arrays )
+{
+  std::string tmpname = m_filename + ".tmp";
+  std::ofstream fout( tmpname.c_str(), std::ios::binary );
+  if( !fout ) {
+    std::cout << "Cannot write the checkpoint: " << m_filename << std::endl;
+    return;
+  }
+
+  fout << CHECKPOINT << std::endl;
+  fout << CHECKPOINT_KEY << "  " << m_key << std::endl;
+  fout << CHECKPOINT_STEP << "  " << step << std::endl;
+  fout << CHECKPOINT_ARRAY_SIZES;
+  for( size_t a = 0; a < arrays.size(); a++ )
+    fout << " " << arrays[a]->size();
+  fout << std::endl;
+  fout << CHECKPOINT_END_HEADER << std::endl;
+  for( size_t a = 0; a < arrays.size(); a++ )
+    if( !arrays[a]->empty() )
+      fout.write( (char*)&( *arrays[a] )[0], sizeof(float) * arrays[a]->size() );
+  fout.close();
+
+  if( !fout || std::rename( tmpname.c_str(), m_filename.c_str() ) != 0 ) {
+    std::cout << "Cannot write the checkpoint: " << m_filename << std::endl;
+    std::remove( tmpname.c_str() );
+    return;
+  }
+  std::cout << "Checkpoint is saved ( " << step << " steps ): " << m_filename << std::endl;
+}
+
+//--- The run is complete
+void featureCheckpoint::remove( void )
+{
+  std::remove( m_filename.c_str() );
+}
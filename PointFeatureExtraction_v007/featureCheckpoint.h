@@ -0,0 +1,28 @@
+#ifndef _featureCheckpoint_H__
+#define _featureCheckpoint_H__
+
+#include <vector>
+#include <string>
+
+//--- Checkpoint of a long feature run ( one local file )
+//    The state is the number of completed steps and a list of float arrays.
+//    The key describes the run ( points, parameters ); a checkpoint with another
+//    key is ignored, so a changed run starts from the beginning.
+//    The file is written to a temporary file and renamed, so that a preempted
+//    write leaves the previous checkpoint intact.
+class featureCheckpoint {
+
+ public:
+  featureCheckpoint( const char* filename );
+
+  void setKey( const std::string &key );
+  bool read( int &step, std::vector< std::vector<float>* > &arrays );
+  void write( int step, const std::vector< std::vector<float>* > &arrays );
+  void remove( void );
+
+ private:
+  std::string m_filename;
+  std::string m_key;
+};
+
+#endif
@@ -0,0 +1,235 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <cmath>
+#include <algorithm>
+
+#include "featureExpression.h"
+
+featureExpression::featureExpression( const char* text ):
+  m_text( text ),
+  m_pos( 0 ),
+  m_depth( 0 ),
+  m_maxDepth( 0 )
+{
+  parseExpression();
+  skipSpace();
+  if( m_pos != m_text.size() )
+    error( "unexpected character" );
+  if( m_program.empty() )
+    error( "empty expression" );
+}
+
+void featureExpression::error( const char* message )
+{
+  std::cout << "ERROR: Feature expression: " << message << std::endl;
+  std::cout << "  " << m_text << std::endl;
+  std::cout << "  " << std::string( std::min( m_pos, m_text.size() ), ' ' ) << "^" << std::endl;
+  exit(1);
+}
+
+void featureExpression::skipSpace( void )
+{
+  while( m_pos < m_text.size() && isspace( (unsigned char)m_text[m_pos] ) )
+    m_pos++;
+}
+
+//--- Number of stack values an instruction takes ( it pushes one value )
+int featureExpression::numOperands( OpCode op )
+{
+  if( op <= PUSH_R )
+    return 0;
+  if( op == ADD || op == SUB || op == MUL || op == DIV ||
+      op == POW || op == MIN || op == MAX )
+    return 2;
+  return 1;
+}
+
+//--- Append an instruction and track the stack depth
+void featureExpression::emit( OpCode op, double value )
+{
+  Instruction ins = { op, value };
+  m_program.push_back( ins );
+
+  m_depth += 1 - numOperands( op );
+  m_maxDepth = std::max( m_maxDepth, m_depth );
+}
+
+//--- expression := term { ( '+' | '-' ) term }
+void featureExpression::parseExpression( void )
+{
+  parseTerm();
+  for(;;) {
+    skipSpace();
+    if( m_pos >= m_text.size() ) return;
+    char c = m_text[m_pos];
+    if( c != '+' && c != '-' ) return;
+    m_pos++;
+    parseTerm();
+    emit( c == '+' ? ADD : SUB );
+  }
+}
+
+//--- term := unary { ( '*' | '/' ) unary }
+void featureExpression::parseTerm( void )
+{
+  parseUnary();
+  for(;;) {
+    skipSpace();
+    if( m_pos >= m_text.size() ) return;
+    char c = m_text[m_pos];
+    if( c != '*' && c != '/' ) return;
+    m_pos++;
+    parseUnary();
+    emit( c == '*' ? MUL : DIV );
+  }
+}
+
+//--- unary := '-' unary | power
+void featureExpression::parseUnary( void )
+{
+  skipSpace();
+  if( m_pos < m_text.size() && m_text[m_pos] == '-' ) {
+    m_pos++;
+    parseUnary();
+    emit( NEG );
+  }
+  else
+    parsePower();
+}
+
+//--- power := primary [ '^' unary ]  ( right associative )
+void featureExpression::parsePower( void )
+{
+  parsePrimary();
+  skipSpace();
+  if( m_pos < m_text.size() && m_text[m_pos] == '^' ) {
+    m_pos++;
+    parseUnary();
+    emit( POW );
+  }
+}
+
+//--- primary := number | variable | function '(' args ')' | '(' expression ')'
+void featureExpression::parsePrimary( void )
+{
+  skipSpace();
+  if( m_pos >= m_text.size() )
+    error( "unexpected end of expression" );
+
+  char c = m_text[m_pos];
+  if( c == '(' ) {
+    m_pos++;
+    parseExpression();
+    skipSpace();
+    if( m_pos >= m_text.size() || m_text[m_pos] != ')' )
+      error( "')' expected" );
+    m_pos++;
+    return;
+  }
+
+  if( isdigit( (unsigned char)c ) || c == '.' ) {
+    const char* begin = m_text.c_str() + m_pos;
+    char* end;
+    double value = strtod( begin, &end );
+    if( end == begin )
+      error( "invalid number" );
+    m_pos += end - begin;
+    emit( PUSH_CONST, value );
+    return;
+  }
+
+  if( !isalpha( (unsigned char)c ) )
+    error( "number, variable or function expected" );
+
+  size_t begin = m_pos;
+  while( m_pos < m_text.size() && isalnum( (unsigned char)m_text[m_pos] ) )
+    m_pos++;
+  std::string name = m_text.substr( begin, m_pos - begin );
+
+  if( name == "l1" ) { emit( PUSH_L1 ); return; }
+  if( name == "l2" ) { emit( PUSH_L2 ); return; }
+  if( name == "l3" ) { emit( PUSH_L3 ); return; }
+  if( name == "n" )  { emit( PUSH_N );  return; }
+  if( name == "r" )  { emit( PUSH_R );  return; }
+
+  OpCode op;
+  int numArgs = 1;
+  if( name == "sqrt" )     op = SQRT;
+  else if( name == "log" ) op = LOG;
+  else if( name == "exp" ) op = EXP;
+  else if( name == "abs" ) op = ABS;
+  else if( name == "min" ) { op = MIN; numArgs = 2; }
+  else if( name == "max" ) { op = MAX; numArgs = 2; }
+  else {
+    m_pos = begin;
+    error( "unknown variable or function" );
+    return;
+  }
+
+  skipSpace();
+  if( m_pos >= m_text.size() || m_text[m_pos] != '(' )
+    error( "'(' expected" );
+  m_pos++;
+  for( int a = 0; a < numArgs; a++ ) {
+    if( a > 0 ) {
+      skipSpace();
+      if( m_pos >= m_text.size() || m_text[m_pos] != ',' )
+        error( "',' expected" );
+      m_pos++;
+    }
+    parseExpression();
+  }
+  skipSpace();
+  if( m_pos >= m_text.size() || m_text[m_pos] != ')' )
+    error( "')' expected" );
+  m_pos++;
+  emit( op );
+}
+
+//--- Run the program over count points ( one stack slot = one array of count values )
+//    Non-finite results are set to 0.
+void featureExpression::evaluate( const double *l1, const double *l2, const double *l3,
+                                  const double *n, const double *r,
+                                  double *out, size_t count )
+{
+  std::vector<double> stack( (size_t)m_maxDepth * count );
+  int top = 0;
+
+  for( size_t p = 0; p < m_program.size(); p++ ) {
+    const Instruction &ins = m_program[p];
+    int numArgs = numOperands( ins.op );
+    if( top < numArgs || top - numArgs >= m_maxDepth ) {
+      std::cout << "ERROR: Feature expression: invalid program ( " << m_text << " )" << std::endl;
+      exit(1);
+    }
+    double *s = stack.data() + (size_t)top * count;          // Next free slot
+    double *b = ( numArgs >= 1 ) ? s - count : NULL;          // Top
+    double *a = ( numArgs >= 2 ) ? s - 2 * count : NULL;      // Second operand from the top
+
+    switch( ins.op ) {
+    case PUSH_CONST: for( size_t i = 0; i < count; i++ ) s[i] = ins.value; top++; break;
+    case PUSH_L1:    for( size_t i = 0; i < count; i++ ) s[i] = l1[i]; top++; break;
+    case PUSH_L2:    for( size_t i = 0; i < count; i++ ) s[i] = l2[i]; top++; break;
+    case PUSH_L3:    for( size_t i = 0; i < count; i++ ) s[i] = l3[i]; top++; break;
+    case PUSH_N:     for( size_t i = 0; i < count; i++ ) s[i] = n[i];  top++; break;
+    case PUSH_R:     for( size_t i = 0; i < count; i++ ) s[i] = r[i];  top++; break;
+    case ADD: for( size_t i = 0; i < count; i++ ) a[i] += b[i]; top--; break;
+    case SUB: for( size_t i = 0; i < count; i++ ) a[i] -= b[i]; top--; break;
+    case MUL: for( size_t i = 0; i < count; i++ ) a[i] *= b[i]; top--; break;
+    case DIV: for( size_t i = 0; i < count; i++ ) a[i] /= b[i]; top--; break;
+    case POW: for( size_t i = 0; i < count; i++ ) a[i] = pow( a[i], b[i] ); top--; break;
+    case MIN: for( size_t i = 0; i < count; i++ ) a[i] = std::min( a[i], b[i] ); top--; break;
+    case MAX: for( size_t i = 0; i < count; i++ ) a[i] = std::max( a[i], b[i] ); top--; break;
+    case NEG:  for( size_t i = 0; i < count; i++ ) b[i] = -b[i]; break;
+    case SQRT: for( size_t i = 0; i < count; i++ ) b[i] = sqrt( b[i] ); break;
+    case LOG:  for( size_t i = 0; i < count; i++ ) b[i] = log( b[i] ); break;
+    case EXP:  for( size_t i = 0; i < count; i++ ) b[i] = exp( b[i] ); break;
+    case ABS:  for( size_t i = 0; i < count; i++ ) b[i] = fabs( b[i] ); break;
+    }
+  }
+
+  for( size_t i = 0; i < count; i++ )
+    out[i] = std::isfinite( stack[i] ) ? stack[i] : 0.0;
+}
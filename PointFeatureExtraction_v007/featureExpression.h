@@ -0,0 +1,71 @@
+#ifndef _featureExpression_H__
+#define _featureExpression_H__
+
+#include <string>
+#include <vector>
+
+//--- User-defined feature value over the eigenvalues
+//    Variables : l1, l2, l3 ( l1 >= l2 >= l3 ), n ( number of neighbors ), r ( radius )
+//    Operators : + - * / ^ ( power ), unary -, parentheses
+//    Functions : sqrt, log, exp, abs, min(a,b), max(a,b)
+//    The expression is parsed once into a stack program, which is evaluated
+//    instruction by instruction over a batch of points ( structure of arrays ).
+class featureExpression {
+
+ public:
+  enum OpCode
+  {
+    PUSH_CONST = 0,
+    PUSH_L1,
+    PUSH_L2,
+    PUSH_L3,
+    PUSH_N,
+    PUSH_R,
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+    POW,
+    NEG,
+    SQRT,
+    LOG,
+    EXP,
+    ABS,
+    MIN,
+    MAX
+  };
+
+  struct Instruction
+  {
+    OpCode op;
+    double value;
+  };
+
+ public:
+  featureExpression( const char* text );
+
+  void evaluate( const double *l1, const double *l2, const double *l3,
+                 const double *n, const double *r,
+                 double *out, size_t count );
+  std::string text( void ) { return m_text; }
+
+ private:
+  void parseExpression( void );
+  void parseTerm( void );
+  void parseUnary( void );
+  void parsePower( void );
+  void parsePrimary( void );
+  void skipSpace( void );
+  void emit( OpCode op, double value = 0.0 );
+  static int numOperands( OpCode op );
+  void error( const char* message );
+
+ private:
+  std::string m_text;
+  size_t m_pos;                          // Parsing position
+  std::vector<Instruction> m_program;
+  int m_depth;                           // Current stack depth while parsing
+  int m_maxDepth;                        // Stack size needed for evaluation
+};
+
+#endif
@@ -0,0 +1,340 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <cmath>
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "featureStatistics.h"
+#include "spcomment_xyz.h"
+
+const int FEATURE_SKETCH_BINS    = 4096;   // Resolution of the quantile sketch
+const int FEATURE_HISTOGRAM_BINS = 128;    // Bins written to the header
+const int FEATURE_BINS_PER_LINE  = 8;      // Header lines stay short for the xyz readers
+const int NUM_FEATURE_QUANTILES  = 6;
+const double FEATURE_QUANTILES[NUM_FEATURE_QUANTILES] = { 0.5, 0.75, 0.9, 0.95, 0.99, 0.999 };
+
+// Threshold suggestions
+const int NUM_TOP_PERCENT    = 3;
+const double TOP_PERCENT[NUM_TOP_PERCENT] = { 10.0, 5.0, 1.0 };
+const double LARGE_TOP_RATIO = 0.1;        // F_th: top 10% of the feature points
+
+featureStatistics::featureStatistics( void ):
+  m_number( 0.0 ),
+  m_histogram( FEATURE_SKETCH_BINS, 0.0 ),
+  m_radius( 0.0 ),
+  m_featureValueID( -1 ),
+  m_rawMaximum( 0.0 )
+{  }
+
+featureStatistics::featureStatistics( const std::vector<float> &ft ):
+  m_number( 0.0 ),
+  m_histogram( FEATURE_SKETCH_BINS, 0.0 ),
+  m_radius( 0.0 ),
+  m_featureValueID( -1 ),
+  m_rawMaximum( 0.0 )
+{
+  add( ft.data(), ft.size() );
+  finish();
+}
+
+//--- Thread-local sketches, merged at the end
+void featureStatistics::add( const float *ft, size_t num )
+{
+  m_number += (double)num;
+
+#pragma omp parallel
+  {
+    std::vector<size_t> local( FEATURE_SKETCH_BINS, 0 );
+#pragma omp for nowait
+    for( long i = 0; i < (long)num; i++ ) {
+      float f = ft[i];
+      int b = 0;
+      if( f >= 1.0f )
+        b = FEATURE_SKETCH_BINS - 1;
+      else if( f > 0.0f )
+        b = (int)( f * FEATURE_SKETCH_BINS );
+      local[b]++;
+    }
+#pragma omp critical
+    for( int b = 0; b < FEATURE_SKETCH_BINS; b++ )
+      m_histogram[b] += (double)local[b];
+  }
+}
+
+//--- Quantiles ( linear within a sketch bin )
+void featureStatistics::finish( void )
+{
+  m_quantileP.assign( FEATURE_QUANTILES, FEATURE_QUANTILES + NUM_FEATURE_QUANTILES );
+  m_quantileValue.assign( NUM_FEATURE_QUANTILES, 0.0 );
+  for( int q = 0; q < NUM_FEATURE_QUANTILES; q++ ) {
+    double rank = FEATURE_QUANTILES[q] * m_number;
+    double cum = 0.0;
+    for( int b = 0; b < FEATURE_SKETCH_BINS; b++ ) {
+      if( m_histogram[b] > 0.0 && cum + m_histogram[b] >= rank ) {
+        double t = ( rank - cum ) / m_histogram[b];
+        m_quantileValue[q] = ( b + t ) / (double)FEATURE_SKETCH_BINS;
+        break;
+      }
+      cum += m_histogram[b];
+    }
+  }
+}
+
+//--- Statistics of loaded feature values
+void featureStatistics::calc( const std::vector<float> &ft )
+{
+  m_number = 0.0;
+  m_histogram.assign( FEATURE_SKETCH_BINS, 0.0 );
+  add( ft.data(), ft.size() );
+  finish();
+}
+
+//--- Statistics in the header of a pfe output ( xyz ascii or xyz binary )
+bool featureStatistics::read( const char* filename )
+{
+  std::ifstream fin( filename );
+  if( !fin )
+    return false;
+
+  m_histogram.clear();
+  m_quantileP.clear();
+  m_quantileValue.clear();
+
+  std::string line;
+  while( std::getline( fin, line ) ) {
+    if( line.empty() )
+      continue;
+    if( line[0] != '#' )
+      break;
+
+    std::istringstream words( line );
+    std::string command;
+    words >> command;
+    if( command == XYZ_FEATURE_BINS ) {
+      int numBins = 0;
+      words >> numBins;
+      if( numBins > 0 )
+        m_histogram.assign( numBins, 0.0 );
+    }
+    else if( command == XYZ_FEATURE_HISTOGRAM ) {
+      int b;
+      double count;
+      words >> b;
+      while( words >> count ) {
+        if( b >= 0 && b < (int)m_histogram.size() )
+          m_histogram[b] = count;
+        b++;
+      }
+    }
+    else if( command == XYZ_FEATURE_QUANTILES ) {
+      double p, q;
+      while( words >> p >> q ) {
+        m_quantileP.push_back( p );
+        m_quantileValue.push_back( q );
+      }
+    }
+    else if( command == XYZ_END_HEADER ) {
+      break;
+    }
+  }
+
+  m_number = 0.0;
+  for( size_t b = 0; b < m_histogram.size(); b++ )
+    m_number += m_histogram[b];
+  return isValid();
+}
+
+//--- Parameters of the features written to the header ( radius 0, ID -1, maximum 0: not written )
+void featureStatistics::setParameters( double radius, int featureValueID, double rawMaximum )
+{
+  m_radius = radius;
+  m_featureValueID = featureValueID;
+  m_rawMaximum = rawMaximum;
+}
+
+//--- Header lines ( every line starts with '#' )
+void featureStatistics::write( std::ofstream &fout )
+{
+  std::streamsize precision = fout.precision( 17 );
+  if( m_radius > 0.0 )
+    fout << XYZ_FEATURE_RADIUS << "  " << m_radius << std::endl;
+  if( m_featureValueID >= 0 )
+    fout << XYZ_FEATURE_VALUE_ID << "  " << m_featureValueID << std::endl;
+  if( m_rawMaximum > 0.0 )
+    fout << XYZ_FEATURE_MAXIMUM << "  " << m_rawMaximum << std::endl;
+  fout.precision( precision );
+
+  //--- Coarse histogram summed from the sketch
+  int ratio = std::max( 1, (int)m_histogram.size() / FEATURE_HISTOGRAM_BINS );
+  std::vector<size_t> histogram( FEATURE_HISTOGRAM_BINS, 0 );
+  for( size_t b = 0; b < m_histogram.size() && (int)( b / ratio ) < FEATURE_HISTOGRAM_BINS; b++ )
+    histogram[b / ratio] += (size_t)m_histogram[b];
+
+  fout << XYZ_FEATURE_BINS << "  " << FEATURE_HISTOGRAM_BINS << std::endl;
+  for( int b = 0; b < FEATURE_HISTOGRAM_BINS; b += FEATURE_BINS_PER_LINE ) {
+    fout << XYZ_FEATURE_HISTOGRAM << "  " << b;
+    for( int k = b; k < b + FEATURE_BINS_PER_LINE && k < FEATURE_HISTOGRAM_BINS; k++ )
+      fout << " " << histogram[k];
+    fout << std::endl;
+  }
+  fout << XYZ_FEATURE_QUANTILES << " ";
+  for( size_t q = 0; q < m_quantileP.size(); q++ )
+    fout << " " << m_quantileP[q] << " " << m_quantileValue[q];
+  fout << std::endl;
+}
+
+//--- Parameters in the header of a pfe output ( false: the file cannot be opened )
+//    radius 0, featureValueID -1 and rawMaximum 0 when they are not written
+bool featureStatistics::readParameters( const char* filename, double &radius, int &featureValueID,
+                                        double &rawMaximum )
+{
+  radius = 0.0;
+  featureValueID = -1;
+  rawMaximum = 0.0;
+  std::ifstream fin( filename );
+  if( !fin )
+    return false;
+
+  std::string line;
+  while( std::getline( fin, line ) ) {
+    if( line.empty() || line == "\r" )
+      continue;
+    if( line[0] != '#' )
+      break;
+
+    std::istringstream words( line );
+    std::string command;
+    words >> command;
+    if( command == XYZ_FEATURE_RADIUS )
+      words >> radius;
+    else if( command == XYZ_FEATURE_VALUE_ID )
+      words >> featureValueID;
+    else if( command == XYZ_FEATURE_MAXIMUM )
+      words >> rawMaximum;
+    else if( command == XYZ_END_HEADER )
+      break;
+  }
+  return true;
+}
+
+void featureStatistics::print( void )
+{
+  std::cout << "Feature quantiles :";
+  for( size_t q = 0; q < m_quantileP.size(); q++ )
+    std::cout << " " << m_quantileP[q] * 100.0 << "%: " << m_quantileValue[q];
+  std::cout << std::endl;
+}
+
+//--- Number of points with feature >= threshold
+double featureStatistics::countAbove( double threshold )
+{
+  int numBins = (int)m_histogram.size();
+  if( threshold <= 0.0 )
+    return m_number;
+  if( threshold >= 1.0 || numBins == 0 )
+    return 0.0;
+
+  double pos = threshold * numBins;
+  int b = (int)pos;
+  double count = m_histogram[b] * ( (double)( b + 1 ) - pos );
+  for( int k = b + 1; k < numBins; k++ )
+    count += m_histogram[k];
+  return count;
+}
+
+//--- Threshold above which count points remain ( inverse of countAbove )
+double featureStatistics::thresholdForCount( double count )
+{
+  int numBins = (int)m_histogram.size();
+  double cum = 0.0;
+  for( int b = numBins - 1; b >= 0; b-- ) {
+    if( m_histogram[b] > 0.0 && cum + m_histogram[b] >= count ) {
+      double t = ( count - cum ) / m_histogram[b];
+      return ( (double)( b + 1 ) - t ) / (double)numBins;
+    }
+    cum += m_histogram[b];
+  }
+  return 0.0;
+}
+
+//--- p-quantile ( from the quantiles if p is one of them, otherwise from the histogram )
+double featureStatistics::quantile( double p )
+{
+  for( size_t q = 0; q < m_quantileP.size(); q++ )
+    if( std::fabs( m_quantileP[q] - p ) < 1.0e-9 )
+      return m_quantileValue[q];
+  return thresholdForCount( ( 1.0 - p ) * m_number );
+}
+
+//--- Otsu split of the bins at or above lower ( maximum between-class variance )
+double featureStatistics::otsuThreshold( double lower )
+{
+  int numBins = (int)m_histogram.size();
+  int b0 = std::max( 0, std::min( numBins - 1, (int)( lower * numBins ) ) );
+
+  double n = 0.0, sum = 0.0;
+  for( int b = b0; b < numBins; b++ ) {
+    double center = ( b + 0.5 ) / numBins;
+    n   += m_histogram[b];
+    sum += m_histogram[b] * center;
+  }
+
+  double best = -1.0;
+  double threshold = lower;
+  double n0 = 0.0, sum0 = 0.0;
+  for( int k = b0 + 1; k < numBins; k++ ) {
+    double center = ( k - 0.5 ) / numBins;
+    n0   += m_histogram[k - 1];
+    sum0 += m_histogram[k - 1] * center;
+    double n1 = n - n0;
+    if( n0 <= 0.0 || n1 <= 0.0 )
+      continue;
+    double m0 = sum0 / n0;
+    double m1 = ( sum - sum0 ) / n1;
+    double between = n0 * n1 * ( m0 - m1 ) * ( m0 - m1 );
+    if( between > best ) {
+      best = between;
+      threshold = (double)k / numBins;
+    }
+  }
+  return threshold;
+}
+
+void featureStatistics::printSmallThresholdSuggestions( void )
+{
+  std::cout << "Suggested f_th ( number of points: " << (size_t)m_number << " )" << std::endl;
+  for( int k = 0; k < NUM_TOP_PERCENT; k++ ) {
+    double fth = quantile( 1.0 - TOP_PERCENT[k] / 100.0 );
+    std::cout << "  Top " << TOP_PERCENT[k] << "% : f_th = " << fth
+              << " ( " << (size_t)countAbove( fth ) << " feature points )" << std::endl;
+  }
+  double otsu = otsuThreshold( 0.0 );
+  std::cout << "  Otsu    : f_th = " << otsu
+            << " ( " << (size_t)countAbove( otsu ) << " feature points )" << std::endl;
+}
+
+void featureStatistics::printLargeThresholdSuggestions( double smallFth )
+{
+  double numFeature = countAbove( smallFth );
+  double top  = thresholdForCount( LARGE_TOP_RATIO * numFeature );
+  double otsu = otsuThreshold( smallFth );
+  std::cout << "Suggested F_th ( feature points: " << (size_t)numFeature << " )" << std::endl;
+  std::cout << "  Top " << LARGE_TOP_RATIO * 100.0 << "% : F_th = " << top
+            << " ( " << (size_t)countAbove( top ) << " points with α_max )" << std::endl;
+  std::cout << "  Otsu    : F_th = " << otsu
+            << " ( " << (size_t)countAbove( otsu ) << " points with α_max )" << std::endl;
+}
+
+void featureStatistics::printSwitchingThresholdSuggestions( double smallFth )
+{
+  double numFeature = countAbove( smallFth );
+  double median = thresholdForCount( 0.5 * numFeature );
+  double otsu   = otsuThreshold( smallFth );
+  std::cout << "Suggested s_th ( compared with the average feature of the neighbors )" << std::endl;
+  std::cout << "  Median of the feature points : s_th = " << median << std::endl;
+  std::cout << "  Otsu above f_th              : s_th = " << otsu << std::endl;
+}
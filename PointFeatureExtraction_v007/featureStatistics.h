@@ -0,0 +1,62 @@
+#ifndef _featureStatistics_H__
+#define _featureStatistics_H__
+
+#include <vector>
+#include <fstream>
+
+//--- Histogram and quantiles of the normalized feature values ( [0, 1] )
+//    Shared by pfe ( statistics written to the output header ) and alphaControl4ply
+//    ( threshold suggestions ).
+//    Each thread counts its points into a fine histogram ( the quantile sketch,
+//    FEATURE_SKETCH_BINS bins ), and the thread histograms are merged.
+//    Quantiles are interpolated in the sketch ( error < 1 / FEATURE_SKETCH_BINS ),
+//    and the coarse histogram written to the header is summed from the sketch.
+//    Values can also be added in parts ( add() ) and summarized by finish().
+//    read() takes the coarse histogram and the quantiles from the header instead
+//    ( no point data is read ). Counts above a threshold are interpolated linearly
+//    inside a histogram bin.
+//    The local-area radius, the feature value type and the maximum before the
+//    normalization of Point PCA are also written to the header, so that the
+//    incremental mode can check its input and rescale the old features.
+class featureStatistics {
+
+ public:
+  featureStatistics( void );
+  featureStatistics( const std::vector<float> &ft );
+
+  void add( const float *ft, size_t num );
+  void finish( void );
+  void calc( const std::vector<float> &ft );
+  bool read( const char* filename );
+
+  void setParameters( double radius, int featureValueID, double rawMaximum = 0.0 );
+  void write( std::ofstream &fout );
+  void print( void );
+
+  static bool readParameters( const char* filename, double &radius, int &featureValueID,
+                              double &rawMaximum );
+
+  double quantile( double p );
+  double otsuThreshold( double lower );
+  double countAbove( double threshold );
+  double thresholdForCount( double count );
+
+  void printSmallThresholdSuggestions( void );
+  void printLargeThresholdSuggestions( double smallFth );
+  void printSwitchingThresholdSuggestions( double smallFth );
+
+ private:
+  double m_number;
+  std::vector<double> m_histogram;     // Bins over [0, 1] ( the sketch, or the histogram of a header )
+  std::vector<double> m_quantileP;     // Quantiles ( p, value )
+  std::vector<double> m_quantileValue;
+  double m_radius;                     // Local-area radius ( 0: not written )
+  int m_featureValueID;                // Feature value type ( -1: not written )
+  double m_rawMaximum;                 // Maximum before the normalization ( 0: not written )
+
+ public:
+  size_t number( void ) { return (size_t)m_number; }
+  bool isValid( void ) { return !m_histogram.empty() && m_number > 0.0; }
+};
+
+#endif
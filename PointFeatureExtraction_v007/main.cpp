@@ -1,9 +1,17 @@
 #include <iostream>
 #include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <vector>
+#include <algorithm>
 #include "importPointClouds.h"
 #include "calculateFeature.h"
+#include "removeDuplicatePoints.h"
+#include "mortonOrder.h"
+#include "previewSampling.h"
 #include "writeFeature.h"
+#include "tiledFeatureExtraction.h"
+#include "pfe_option.h"
 
 #include <kvs/PolygonObject>
 #include <kvs/PointObject>
@@ -15,34 +23,238 @@
 
 const char OUT_FILE[] = "../XYZ_DATA/out.xyz";
 
+//--- Points of ply followed by the points of delta ( normals and colors if both have them )
+kvs::PolygonObject* appendPoints( kvs::PolygonObject *ply, kvs::PolygonObject *delta )
+{
+  size_t num0 = ply->numberOfVertices();
+  size_t num1 = delta->numberOfVertices();
+  bool hasNormal = ( num0 == ply->numberOfNormals() && num1 == delta->numberOfNormals() );
+  bool hasColor  = ( num0 == ply->numberOfColors()  && num1 == delta->numberOfColors() );
+
+  kvs::ValueArray<kvs::Real32> coords0  = ply->coords();
+  kvs::ValueArray<kvs::Real32> coords1  = delta->coords();
+  kvs::ValueArray<kvs::Real32> normals0 = ply->normals();
+  kvs::ValueArray<kvs::Real32> normals1 = delta->normals();
+  kvs::ValueArray<kvs::UInt8>  colors0  = ply->colors();
+  kvs::ValueArray<kvs::UInt8>  colors1  = delta->colors();
+
+  std::vector<kvs::Real32> coords, normals;
+  std::vector<kvs::UInt8> colors;
+  for( size_t i = 0; i < 3 * num0; i++ ) {
+    coords.push_back( coords0[i] );
+    if( hasNormal ) normals.push_back( normals0[i] );
+    if( hasColor )  colors.push_back( colors0[i] );
+  }
+  for( size_t i = 0; i < 3 * num1; i++ ) {
+    coords.push_back( coords1[i] );
+    if( hasNormal ) normals.push_back( normals1[i] );
+    if( hasColor )  colors.push_back( colors1[i] );
+  }
+
+  kvs::PolygonObject *merged = new kvs::PolygonObject();
+  merged->setPolygonType( kvs::PolygonObject::UnknownPolygonType );
+  merged->setColorType( kvs::PolygonObject::VertexColor );
+  merged->setNormalType( kvs::PolygonObject::VertexNormal );
+  merged->setCoords( kvs::ValueArray<kvs::Real32>( coords ) );
+  merged->setNormals( kvs::ValueArray<kvs::Real32>( normals ) );
+  merged->setColors( kvs::ValueArray<kvs::UInt8>( colors ) );
+  merged->updateMinMaxCoords();
+  return merged;
+}
+
+//--- Values of the target points ( dim per point ) -> values of the input points
+static std::vector<float> restoreInputOrder( std::vector<float> values, size_t dim,
+                                             mortonOrder *mo, removeDuplicatePoints *dd )
+{
+  if( mo != NULL )
+    values = mo->restoreOrder( values, dim );
+  if( dd != NULL )
+    values = dd->restoreOrder( values, dim );
+  return values;
+}
+
 int main( int argc, char** argv )
 {
   char outXYZfile[512];
   strcpy( outXYZfile, OUT_FILE );
   if( argc < 2 ) {
-    std::cout << "USAGE   : " << argv[0] << " [input_point_cloud_data] [output_point_cloud_data]" << std::endl;
+    std::cout << "USAGE   : " << argv[0] << " [input_point_cloud_data] [output_point_cloud_data] [options]" << std::endl;
     std::cout << "EXAMPLE : " << argv[0] << " [input_point_cloud.ply] [output_point_cloud.xyz]" << std::endl;
+    std::cout << "OPTIONS : " << NORMAL_ESTIMATION_OPTION << " (output PCA normals), "
+              << VIEWPOINT_OPTION << " x y z (viewpoint for normal orientation)" << std::endl;
+    std::cout << "          " << PLANE_SEGMENTATION_OPTION << " (skip PCA inside large planar regions), "
+              << DUPLICATE_REMOVAL_OPTION << " tol (merge points closer than tol, 0: identical points)" << std::endl;
+    std::cout << "          " << AUTO_RADIUS_OPTION << " (local-area radius from the measured point spacing)" << std::endl;
+    std::cout << "          " << PREVIEW_STRIDE_OPTION << " k (preview: every k-th point), "
+              << PREVIEW_FRACTION_OPTION << " f (preview: random fraction f of the points)" << std::endl;
+    std::cout << "          " << FEATURE_EXPRESSION_OPTION << " \"expr\" (feature value from l1, l2, l3, n, r, e.g. \"(l2-l3)/l1\")" << std::endl;
+    std::cout << "          " << INCREMENTAL_OPTION << " delta (input: feature file of pfe, recompute only around the points of delta)" << std::endl;
+    std::cout << "          " << ROI_BOX_OPTION << " xmin ymin zmin xmax ymax zmax (features only inside the box), "
+              << ROI_INDEX_OPTION << " file (features only at the point indices in file)" << std::endl;
+    std::cout << "          " << EIGEN_CACHE_OPTION << " dir (save eigenvalues in dir, reuse them for the same points and radius)" << std::endl;
+    std::cout << "          " << CHECKPOINT_OPTION << " file (minimum entropy: save the state after each radius, resume from file)" << std::endl;
+    std::cout << "          " << OUT_OF_CORE_OPTION << " MB (out-of-core Point PCA of an xyz file in tiles within MB of memory)" << std::endl;
+    std::cout << "          " << NUM_PROCESSES_OPTION << " k (out-of-core: tiles computed by k worker processes), "
+              << OUT_OF_CORE_WORKER_OPTION << " (worker joining the out-of-core run of the output file)" << std::endl;
+    std::cout << "          " << MORTON_ORDER_OPTION << " (compute in Morton order, output in the input order), "
+              << MORTON_KEEP_OPTION << " (compute and output in Morton order)" << std::endl;
     exit( 1 );
-  } else if( argc == 3 ) {
-    strcpy( outXYZfile, argv[2] );
-  }
-  //--- Inheritance of KVS::PolygonObject
-  ImportPointClouds *ply = new ImportPointClouds( argv[1] );
-  ply->updateMinMaxCoords();
-  std::cout << "PLY Mim, Max Coords:" << std::endl;
-  std::cout << "Min : " << ply->minObjectCoord() << std::endl;
-  std::cout << "Max : " << ply->maxObjectCoord() << std::endl;
-  std::cout << std::endl;
+  }
+
+  //---- Command-line Option
+  bool isEstimateNormal = false;
+  bool isPlaneSegmentation = false;
+  double duplicateTolerance = -1.0;
+  bool isAutoRadius = false;
+  int previewStride = 0;
+  double previewFraction = 0.0;
+  featureExpression *expression = NULL;
+  char *deltaFile = NULL;
+  bool isRoiBox = false;
+  kvs::Vector3f roiMin( 0.0, 0.0, 0.0 ), roiMax( 0.0, 0.0, 0.0 );
+  char *roiIndexFile = NULL;
+  char *eigenCacheDir = NULL;
+  char *checkpointFile = NULL;
+  double memoryBudget = 0.0;
+  int numProcesses = 0;
+  bool isOutOfCoreWorker = false;
+  bool isMortonOrder = false;
+  bool isMortonKeep = false;
+  kvs::Vector3f viewpoint( 0.0, 0.0, 0.0 );
+  for( int i = 2; i < argc; i++ ) {
+    if( !strcmp( NORMAL_ESTIMATION_OPTION, argv[i] ) ) {
+      isEstimateNormal = true;
+    }
+    else if( !strcmp( VIEWPOINT_OPTION, argv[i] ) && i + 3 < argc ) {
+      viewpoint = kvs::Vector3f( atof( argv[i+1] ), atof( argv[i+2] ), atof( argv[i+3] ) );
+      i += 3;
+    }
+    else if( !strcmp( PLANE_SEGMENTATION_OPTION, argv[i] ) ) {
+      isPlaneSegmentation = true;
+    }
+    else if( !strcmp( AUTO_RADIUS_OPTION, argv[i] ) ) {
+      isAutoRadius = true;
+    }
+    else if( !strcmp( PREVIEW_STRIDE_OPTION, argv[i] ) && i + 1 < argc ) {
+      previewStride = atoi( argv[i+1] );
+      i++;
+    }
+    else if( !strcmp( PREVIEW_FRACTION_OPTION, argv[i] ) && i + 1 < argc ) {
+      previewFraction = atof( argv[i+1] );
+      i++;
+    }
+    else if( !strcmp( FEATURE_EXPRESSION_OPTION, argv[i] ) && i + 1 < argc ) {
+      expression = new featureExpression( argv[i+1] );
+      i++;
+    }
+    else if( !strcmp( INCREMENTAL_OPTION, argv[i] ) && i + 1 < argc ) {
+      deltaFile = argv[i+1];
+      i++;
+    }
+    else if( !strcmp( ROI_BOX_OPTION, argv[i] ) && i + 6 < argc ) {
+      isRoiBox = true;
+      roiMin = kvs::Vector3f( atof( argv[i+1] ), atof( argv[i+2] ), atof( argv[i+3] ) );
+      roiMax = kvs::Vector3f( atof( argv[i+4] ), atof( argv[i+5] ), atof( argv[i+6] ) );
+      i += 6;
+    }
+    else if( !strcmp( ROI_INDEX_OPTION, argv[i] ) && i + 1 < argc ) {
+      roiIndexFile = argv[i+1];
+      i++;
+    }
+    else if( !strcmp( EIGEN_CACHE_OPTION, argv[i] ) && i + 1 < argc ) {
+      eigenCacheDir = argv[i+1];
+      i++;
+    }
+    else if( !strcmp( CHECKPOINT_OPTION, argv[i] ) && i + 1 < argc ) {
+      checkpointFile = argv[i+1];
+      i++;
+    }
+    else if( !strcmp( OUT_OF_CORE_OPTION, argv[i] ) && i + 1 < argc ) {
+      memoryBudget = atof( argv[i+1] );
+      i++;
+    }
+    else if( !strcmp( NUM_PROCESSES_OPTION, argv[i] ) && i + 1 < argc ) {
+      numProcesses = atoi( argv[i+1] );
+      i++;
+    }
+    else if( !strcmp( OUT_OF_CORE_WORKER_OPTION, argv[i] ) ) {
+      isOutOfCoreWorker = true;
+    }
+    else if( !strcmp( MORTON_ORDER_OPTION, argv[i] ) ) {
+      isMortonOrder = true;
+    }
+    else if( !strcmp( MORTON_KEEP_OPTION, argv[i] ) ) {
+      isMortonOrder = true;
+      isMortonKeep = true;
+    }
+    else if( !strcmp( DUPLICATE_REMOVAL_OPTION, argv[i] ) && i + 1 < argc ) {
+      duplicateTolerance = atof( argv[i+1] );
+      i++;
+    }
+    else if( argv[i][0] == '-' ) {
+      //--- Unknown option, or an option without its arguments
+      std::cout << "ERROR: Unknown option or missing argument: " << argv[i] << std::endl;
+      exit(1);
+    }
+    else {
+      if( strlen( argv[i] ) >= sizeof( outXYZfile ) ) {
+        std::cout << "ERROR: Output file name is too long: " << argv[i] << std::endl;
+        exit(1);
+      }
+      strncpy( outXYZfile, argv[i], sizeof( outXYZfile ) - 1 );
+      outXYZfile[ sizeof( outXYZfile ) - 1 ] = '\0';
+    }
+  }
+  //--- Worker of a sharded out-of-core run ( settings from the job file, no prompt )
+  if( isOutOfCoreWorker ) {
+    calculateFeature *ft = new calculateFeature();
+    tiledFeatureExtraction tiled( argv[1], outXYZfile, memoryBudget );
+    tiled.execWorker( ft );
+    return 0;
+  }
+  if( numProcesses > 0 && memoryBudget <= 0.0 ) {
+    std::cout << "ERROR: " << NUM_PROCESSES_OPTION << " needs the out-of-core mode ( "
+              << OUT_OF_CORE_OPTION << " MB )" << std::endl;
+    exit(1);
+  }
+
+  //--- Inheritance of KVS::PolygonObject ( out-of-core: streamed later )
+  ImportPointClouds *ply = NULL;
+  if( memoryBudget <= 0.0 ) {
+    ply = new ImportPointClouds( argv[1] );
+    ply->updateMinMaxCoords();
+    std::cout << "PLY Mim, Max Coords:" << std::endl;
+    std::cout << "Min : " << ply->minObjectCoord() << std::endl;
+    std::cout << "Max : " << ply->maxObjectCoord() << std::endl;
+    std::cout << std::endl;
+  }
 
   //--- Set up for calculating feature
   calculateFeature *ft = new calculateFeature();
+  if( isEstimateNormal ) {
+    std::cout << "PCA normals are output ( viewpoint: " << viewpoint << " )" << std::endl;
+    std::cout << std::endl;
+    ft->setNormalEstimation( true, viewpoint );
+  }
+  if( isPlaneSegmentation )
+    ft->setPlaneSegmentation( true );
+  if( isAutoRadius )
+    ft->setAutoSearchRadius( true );
+  if( eigenCacheDir != NULL )
+    ft->setEigenCache( new eigenCache( eigenCacheDir ) );
+  if( checkpointFile != NULL )
+    ft->setCheckpoint( new featureCheckpoint( checkpointFile ) );
 
   //--- Select type of Feature Calculation
   int featureCalculationID;
 
   std::cout << "Feature calculation type" << std::endl;
   std::cout << "Point PCA: " << calculateFeature::PointPCA << ", ";
-  std::cout << "Minimum entropy PCA: " << calculateFeature::MinimumEntropyFeature << std::endl;
+  std::cout << "Minimum entropy PCA: " << calculateFeature::MinimumEntropyFeature << ", ";
+  std::cout << "Multi-scale PCA: " << calculateFeature::MultiScaleFeature << ", ";
+  std::cout << "Adaptive-radius PCA: " << calculateFeature::AdaptiveRadiusFeature << ", ";
+  std::cout << "Coarse-to-fine PCA: " << calculateFeature::CoarseToFineFeature << ", ";
+  std::cout << "Mesh dihedral angle: " << calculateFeature::MeshDihedralFeature << std::endl;
 
   std::cout << "Select an ID >> ";
   std::cin >> featureCalculationID;
@@ -54,6 +266,14 @@ int main( int argc, char** argv )
     ft->setFeatureType( calculateFeature::PointPCA );
   else if ( featureCalculationID == calculateFeature::MinimumEntropyFeature )
     ft->setFeatureType( calculateFeature::MinimumEntropyFeature );
+  else if ( featureCalculationID == calculateFeature::MultiScaleFeature )
+    ft->setFeatureType( calculateFeature::MultiScaleFeature );
+  else if ( featureCalculationID == calculateFeature::AdaptiveRadiusFeature )
+    ft->setFeatureType( calculateFeature::AdaptiveRadiusFeature );
+  else if ( featureCalculationID == calculateFeature::CoarseToFineFeature )
+    ft->setFeatureType( calculateFeature::CoarseToFineFeature );
+  else if ( featureCalculationID == calculateFeature::MeshDihedralFeature )
+    ft->setFeatureType( calculateFeature::MeshDihedralFeature );
 
   // ft->setFeatureType( calculateFeature::PlaneBasedFeature );
 
@@ -64,39 +284,199 @@ int main( int argc, char** argv )
   //---- Calculation
   int featureValueID;
 
-  std::cout << "Feature value type" << std::endl;
-  std::cout << "Change of curvature: " << calculateFeature::CHANGE_OF_CURVATURE_ID << ", ";
-  std::cout << "Aplanarity: " << calculateFeature::APLANARITY_ID << ", ";
-  std::cout << "Linearity: " << calculateFeature::LINEARITY_ID << ", ";
-  std::cout << "Eigentropy: " << calculateFeature::EIGENTROPY_ID << std::endl;
+  if( expression != NULL ) {
+    if( featureCalculationID != calculateFeature::PointPCA ) {
+      std::cout << "ERROR: " << FEATURE_EXPRESSION_OPTION << " is available only for Point PCA" << std::endl;
+      exit(1);
+    }
+    std::cout << "Feature value type ==> " << expression->text() << std::endl;
+    std::cout << std::endl;
+    ft->setFeatureValueID( calculateFeature::CHANGE_OF_CURVATURE_ID );
+    ft->setFeatureExpression( expression );
+  }
+  else {
+    std::cout << "Feature value type" << std::endl;
+    std::cout << "Change of curvature: " << calculateFeature::CHANGE_OF_CURVATURE_ID << ", ";
+    std::cout << "Aplanarity: " << calculateFeature::APLANARITY_ID << ", ";
+    std::cout << "Linearity: " << calculateFeature::LINEARITY_ID << ", ";
+    std::cout << "Eigentropy: " << calculateFeature::EIGENTROPY_ID << std::endl;
+
+    std::cout << "Select an ID >> ";
+    std::cin >> featureValueID;
+
+    std::cout << "Feature value type ==> " << featureValueID << std::endl;
+    std::cout << std::endl;
+
+    if ( featureValueID == calculateFeature::CHANGE_OF_CURVATURE_ID )
+      ft->setFeatureValueID( calculateFeature::CHANGE_OF_CURVATURE_ID );
+    else if ( featureValueID == calculateFeature::APLANARITY_ID )
+      ft->setFeatureValueID( calculateFeature::APLANARITY_ID );
+    else if ( featureValueID == calculateFeature::LINEARITY_ID )
+      ft->setFeatureValueID( calculateFeature::LINEARITY_ID );
+    else if ( featureValueID == calculateFeature::EIGENTROPY_ID )
+      ft->setFeatureValueID( calculateFeature::EIGENTROPY_ID );
+  }
 
-  std::cout << "Select an ID >> ";
-  std::cin >> featureValueID;
+  //--- Out-of-core: tiles streamed from the input file ( no display )
+  if( memoryBudget > 0.0 ) {
+    if( featureCalculationID != calculateFeature::PointPCA ) {
+      std::cout << "ERROR: Out-of-core mode is available only for Point PCA" << std::endl;
+      exit(1);
+    }
+    std::cout << "Out-of-core mode: " << NORMAL_ESTIMATION_OPTION << ", " << PLANE_SEGMENTATION_OPTION << ", "
+              << AUTO_RADIUS_OPTION << ", " << DUPLICATE_REMOVAL_OPTION << ", " << PREVIEW_STRIDE_OPTION << ", "
+              << INCREMENTAL_OPTION << ", " << ROI_BOX_OPTION << " and " << MORTON_ORDER_OPTION << " are not used" << std::endl;
+    ft->setNormalEstimation( false );
+    ft->setPlaneSegmentation( false );
+    ft->setAutoSearchRadius( false );
+    tiledFeatureExtraction tiled( argv[1], outXYZfile, memoryBudget );
+    tiled.setWorkers( numProcesses, argv[0] );
+    tiled.exec( ft );
+    return 0;
+  }
 
-  std::cout << "Feature value type ==> " << featureValueID << std::endl;
-  std::cout << std::endl;
+  //--- Incremental: old points ( with the features of the previous run ) followed by the new points
+  kvs::PolygonObject *target = ply;
+  if( deltaFile != NULL ) {
+    if( duplicateTolerance >= 0.0 || previewStride > 0 || previewFraction > 0.0 ) {
+      std::cout << "ERROR: " << INCREMENTAL_OPTION << " cannot be used with " << DUPLICATE_REMOVAL_OPTION << ", "
+                << PREVIEW_STRIDE_OPTION << " and " << PREVIEW_FRACTION_OPTION
+                << " ( the old points must keep their indices and all the points are computed )" << std::endl;
+      exit(1);
+    }
+    std::vector<float> oldFt = ply->featureData();
+    if( oldFt.size() != ply->numberOfVertices() ) {
+      std::cout << "ERROR: Incremental mode needs a feature file of pfe as the input" << std::endl;
+      exit(1);
+    }
+    double oldRadius, oldRawMax;
+    int oldFeatureValueID;
+    featureStatistics::readParameters( argv[1], oldRadius, oldFeatureValueID, oldRawMax );
+    ImportPointClouds *delta = new ImportPointClouds( deltaFile );
+    target = appendPoints( ply, delta );
+    std::cout << "Incremental: " << ply->numberOfVertices() << " old points + "
+              << delta->numberOfVertices() << " new points" << std::endl;
+    std::cout << std::endl;
+    ft->setIncremental( oldFt, oldRadius, oldFeatureValueID, oldRawMax );
+  }
 
-  if ( featureValueID == calculateFeature::CHANGE_OF_CURVATURE_ID )
-    ft->setFeatureValueID( calculateFeature::CHANGE_OF_CURVATURE_ID );
-  else if ( featureValueID == calculateFeature::APLANARITY_ID )
-    ft->setFeatureValueID( calculateFeature::APLANARITY_ID );
-  else if ( featureValueID == calculateFeature::LINEARITY_ID )
-    ft->setFeatureValueID( calculateFeature::LINEARITY_ID );
-  else if ( featureValueID == calculateFeature::EIGENTROPY_ID )
-    ft->setFeatureValueID( calculateFeature::EIGENTROPY_ID );
+  //--- Remove duplicate points before building the octree
+  removeDuplicatePoints *dd = NULL;
+  if( duplicateTolerance >= 0.0 ) {
+    if( featureCalculationID == calculateFeature::MeshDihedralFeature ) {
+      std::cout << "Duplicate-point removal is not available for meshes" << std::endl;
+    }
+    else {
+      dd = new removeDuplicatePoints( ply, duplicateTolerance );
+      target = dd;
+    }
+    std::cout << std::endl;
+  }
 
-  ft->calc( ply );
+  //--- Morton order: points close in space are close in memory during the calculation
+  //    ( not for meshes, and not with the options that refer to the input point indices )
+  mortonOrder *mo = NULL;
+  bool isSubset = ( previewStride > 1 || ( previewFraction > 0.0 && previewFraction < 1.0 )
+                    || isRoiBox || roiIndexFile != NULL );
+  if( isMortonOrder ) {
+    if( featureCalculationID == calculateFeature::MeshDihedralFeature )
+      std::cout << "Morton order is not available for meshes" << std::endl;
+    else if( deltaFile != NULL || isSubset )
+      std::cout << "Morton order is not used with " << INCREMENTAL_OPTION << ", " << PREVIEW_STRIDE_OPTION << ", "
+                << PREVIEW_FRACTION_OPTION << ", " << ROI_BOX_OPTION << " and " << ROI_INDEX_OPTION << std::endl;
+    else {
+      mo = new mortonOrder( target );
+      target = mo;
+    }
+    std::cout << std::endl;
+  }
+  bool isInputOrder = ( mo == NULL || !isMortonKeep );
+
+  //--- Preview: features only at a subset of the points ( all the points are neighbors )
+  std::vector<size_t> previewInd;
+  if( previewStride > 1 || ( previewFraction > 0.0 && previewFraction < 1.0 ) ) {
+    previewInd = selectPreviewPoints( target->numberOfVertices(), previewStride, previewFraction );
+    std::cout << "Preview: " << previewInd.size() << " / " << target->numberOfVertices() << " points" << std::endl;
+    std::cout << std::endl;
+    ft->setPreviewPoints( previewInd );
+  }
 
-  //--- Getting Feature value
-  std::vector<float> ftvec = ft->feature( );
+  //--- Region of interest: features only at the ROI points ( with a halo of neighbors )
+  if( isRoiBox ) {
+    ft->setRegionOfInterest( roiMin, roiMax );
+  }
+  else if( roiIndexFile != NULL ) {
+    std::ifstream fin( roiIndexFile );
+    if( !fin ) {
+      std::cout << "ERROR: Cannot open " << roiIndexFile << std::endl;
+      exit(1);
+    }
+    std::vector<size_t> roiInd;
+    size_t index;
+    while( fin >> index )
+      roiInd.push_back( index );
+
+    //--- Indices of the input points -> merged points ( each merged point once )
+    if( dd != NULL ) {
+      const std::vector<size_t> &indexMap = dd->indexMap();
+      for( size_t r = 0; r < roiInd.size(); r++ ) {
+        if( roiInd[r] >= indexMap.size() ) {
+          std::cout << "ERROR: ROI index " << roiInd[r] << " is out of range ( "
+                    << indexMap.size() << " points )" << std::endl;
+          exit(1);
+        }
+        roiInd[r] = indexMap[ roiInd[r] ];
+      }
+      std::sort( roiInd.begin(), roiInd.end() );
+      roiInd.erase( std::unique( roiInd.begin(), roiInd.end() ), roiInd.end() );
+    }
+    ft->setRegionOfInterest( roiInd );
+  }
+
+  ft->calc( target );
+
+  //--- Getting Feature value ( in the input order, the ROI points or the preview points )
+  std::vector<float> ftvec = ft->releaseFeature( );
+  kvs::PolygonObject *out = ( ( dd != NULL || mo != NULL ) && isInputOrder ) ? ply : target;
+  if( ft->isRegionOfInterest() )
+    out = extractPreviewPoints( target, ft->roiIndex() );
+  else if( ft->isPreview() )
+    out = extractPreviewPoints( target, previewInd );
+  else if( isInputOrder )
+    ftvec = restoreInputOrder( ftvec, 1, mo, dd );
+
+  //--- Replace normals with the PCA normals
+  if( isEstimateNormal ) {
+    std::vector<float> nvec = ft->releaseEstimatedNormal( );
+    if( isInputOrder && !ft->isPreview() )
+      nvec = restoreInputOrder( nvec, 3, mo, dd );
+    if( nvec.size() == 3 * out->numberOfVertices() )
+      out->setNormals( kvs::ValueArray<kvs::Real32>( nvec ) );
+  }
 
   //-- Output File for "xyzrgbf"
   WritingDataType type = Ascii; // Writing data as ascii
   //  WritingDataType type = Binary;    // Writing data as Binary
-  writeFeature( ply, ftvec, outXYZfile, type );
+  featureStatistics stats( ftvec );
+  stats.print();
+  if( featureCalculationID == calculateFeature::PointPCA )
+    stats.setParameters( ft->searchRadius(), ( expression == NULL ) ? (int)ft->featureValueID() : -1,
+                         ft->rawMaxFeature() );
+  writeFeature( out, ftvec, outXYZfile, type, &stats );
+
+  //-- Output File for features at K radii ( binary only )
+  if ( featureCalculationID == calculateFeature::MultiScaleFeature ) {
+    std::string msfile( outXYZfile );
+    msfile += "_ms";
+    std::vector<float> msft = ft->releaseMultiScaleFeature( );
+    if( isInputOrder )
+      msft = restoreInputOrder( msft, ft->numberOfScales(), mo, dd );
+    std::vector<double> radii = ft->scaleRadii( );
+    writeMultiScaleFeature( isInputOrder ? ply : target, msft, radii, msfile.c_str() );
+  }
 
   //--- Convert PolygonObject to PointObject
-  kvs::PointObject* object = new kvs::PointObject( *ply );
+  kvs::PointObject* object = new kvs::PointObject( *out );
 
   float ftMax = (float)ft->maxFeature();
   // float ftMin = (float)ft->minFeature();
@@ -106,7 +486,8 @@ int main( int argc, char** argv )
   cmap.create();
 
   std::vector<unsigned char> cl;
-  for( size_t i=0; i<ply->numberOfVertices(); i++ ) {
+  cl.reserve( 3 * out->numberOfVertices() );
+  for( size_t i=0; i<out->numberOfVertices(); i++ ) {
     kvs::RGBColor color( cmap.at( ftvec[i] ) );
     cl.push_back( color.r() );
     cl.push_back( color.g() );
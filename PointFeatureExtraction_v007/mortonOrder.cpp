@@ -0,0 +1,122 @@
+#include <iostream>
+#include <cstdlib>
+#include <algorithm>
+
+#include "mortonOrder.h"
+#include "parallelSortKeys.h"
+
+const int MORTON_BITS = 21;                                        // Bits per axis of a key
+const double MORTON_MAX = (double)( ( 1ULL << MORTON_BITS ) - 1 ); // Maximum cell index per axis
+
+//--- Bits of x ( MORTON_BITS ) at every third position
+static unsigned long long spreadBits( unsigned long long x )
+{
+  x &= 0x1fffffULL;
+  x = ( x | ( x << 32 ) ) & 0x1f00000000ffffULL;
+  x = ( x | ( x << 16 ) ) & 0x1f0000ff0000ffULL;
+  x = ( x | ( x << 8 ) )  & 0x100f00f00f00f00fULL;
+  x = ( x | ( x << 4 ) )  & 0x10c30c30c30c30c3ULL;
+  x = ( x | ( x << 2 ) )  & 0x1249249249249249ULL;
+  return x;
+}
+
+mortonOrder::mortonOrder( void )
+{  }
+
+mortonOrder::mortonOrder( kvs::PolygonObject* ply )
+{
+  SuperClass::setPolygonType( kvs::PolygonObject::UnknownPolygonType );
+  SuperClass::setColorType( kvs::PolygonObject::VertexColor );
+  SuperClass::setNormalType( kvs::PolygonObject::VertexNormal );
+
+  exec( ply );
+}
+
+//--- Values of the reordered points ( dim per point ) -> values of the input points
+std::vector<float> mortonOrder::restoreOrder( const std::vector<float> &values, size_t dim )
+{
+  size_t num = m_order.size();
+  std::vector<float> restored( dim * num, 0.0f );
+  if( values.size() != dim * num )
+    return restored;
+
+#pragma omp parallel for
+  for( long j = 0; j < (long)num; j++ ) {
+    for( size_t k = 0; k < dim; k++ )
+      restored[dim*m_order[j]+k] = values[dim*j+k];
+  }
+  return restored;
+}
+
+void mortonOrder::exec( kvs::PolygonObject* ply )
+{
+  size_t numVert = ply->numberOfVertices();
+  if( numVert == 0 ) {
+    std::cout << "ERROR: No points for Morton ordering" << std::endl;
+    exit(1);
+  }
+  bool hasNormal = ( ply->numberOfNormals() == numVert );
+  bool hasColor  = ( ply->numberOfColors() == numVert );
+
+  kvs::ValueArray<kvs::Real32> coords  = ply->coords();
+  kvs::ValueArray<kvs::Real32> normals = ply->normals();
+  kvs::ValueArray<kvs::UInt8>  colors  = ply->colors();
+  const float *pcoords = coords.data();
+
+  //--- Bounding box
+  float minX = pcoords[0], minY = pcoords[1], minZ = pcoords[2];
+  float maxX = pcoords[0], maxY = pcoords[1], maxZ = pcoords[2];
+#pragma omp parallel for reduction(min:minX,minY,minZ) reduction(max:maxX,maxY,maxZ)
+  for( long i = 0; i < (long)numVert; i++ ) {
+    minX = std::min( minX, pcoords[3*i] );
+    minY = std::min( minY, pcoords[3*i+1] );
+    minZ = std::min( minZ, pcoords[3*i+2] );
+    maxX = std::max( maxX, pcoords[3*i] );
+    maxY = std::max( maxY, pcoords[3*i+1] );
+    maxZ = std::max( maxZ, pcoords[3*i+2] );
+  }
+  double origin[3] = { minX, minY, minZ };
+  double extent = std::max( (double)maxX - minX, std::max( (double)maxY - minY, (double)maxZ - minZ ) );
+  double scale = ( extent > 0.0 ) ? MORTON_MAX / extent : 0.0;
+
+  //--- Key of each point ( the same cell size on every axis )
+  std::cout << "Calculating Morton keys..." << std::endl;
+  std::vector<KeyIndex> keys( numVert );
+#pragma omp parallel for
+  for( long i = 0; i < (long)numVert; i++ ) {
+    unsigned long long c[3];
+    for( int k = 0; k < 3; k++ ) {
+      double x = ( pcoords[3*i+k] - origin[k] ) * scale;
+      c[k] = (unsigned long long)std::min( MORTON_MAX, std::max( 0.0, x ) );
+    }
+    keys[i].first = spreadBits( c[0] ) | ( spreadBits( c[1] ) << 1 ) | ( spreadBits( c[2] ) << 2 );
+    keys[i].second = i;
+  }
+
+  std::cout << "Sorting Morton keys..." << std::endl;
+  parallelSortKeys( keys );
+
+  //--- Attributes in the key order
+  kvs::ValueArray<kvs::Real32> sortedCoords( 3 * numVert );
+  kvs::ValueArray<kvs::Real32> sortedNormals( hasNormal ? 3 * numVert : 0 );
+  kvs::ValueArray<kvs::UInt8>  sortedColors( hasColor ? 3 * numVert : 0 );
+  m_order.assign( numVert, 0 );
+
+#pragma omp parallel for
+  for( long j = 0; j < (long)numVert; j++ ) {
+    size_t id = keys[j].second;
+    m_order[j] = id;
+    for( int k = 0; k < 3; k++ ) {
+      sortedCoords[3*j+k] = pcoords[3*id+k];
+      if( hasNormal ) sortedNormals[3*j+k] = normals[3*id+k];
+      if( hasColor )  sortedColors[3*j+k]  = colors[3*id+k];
+    }
+  }
+
+  SuperClass::setCoords( sortedCoords );
+  SuperClass::setNormals( sortedNormals );
+  SuperClass::setColors( sortedColors );
+  SuperClass::updateMinMaxCoords();
+
+  std::cout << "Morton order : " << numVert << " points" << std::endl;
+}
@@ -0,0 +1,37 @@
+#ifndef _mortonOrder_H__
+#define _mortonOrder_H__
+
+#include <kvs/Module>
+#include <kvs/PolygonObject>
+#include <vector>
+#include <utility>
+
+//--- Reordering of the points along the Morton ( Z-order ) curve
+//    Coordinates are quantized in the bounding box ( MORTON_BITS per axis ) and
+//    the bits of the three axes are interleaved into one key. Coordinates, normals
+//    and colors are sorted by the key, so that the points close in space are close
+//    in memory ( neighbor search of consecutive points hits the same octree nodes ).
+//    The order map keeps the input point of every reordered point, so that results
+//    can be restored to the input order.
+class mortonOrder: public kvs::PolygonObject {
+  kvsModuleSuperClass( kvs::PolygonObject );
+
+ public:
+  typedef std::pair<unsigned long long, size_t> KeyIndex;
+
+  mortonOrder( void );
+  mortonOrder( kvs::PolygonObject* ply );
+
+  std::vector<float> restoreOrder( const std::vector<float> &values, size_t dim );
+
+ private:
+  void exec( kvs::PolygonObject* ply );
+
+ private:
+  std::vector<size_t> m_order;   // Reordered point -> input point
+
+ public:
+  const std::vector<size_t>& order( void ) { return m_order; }
+};
+
+#endif
@@ -3,7 +3,7 @@
 octree::octree(float points[], size_t np, double range[], int nMin)
 {
 
-  octreeRoot = new octreeNode;
+  octreeRoot = new octreeNode();
 
   for (size_t i = 0; i < np; i++) {
     octreeRoot->pInd.push_back(i);
@@ -15,3 +15,8 @@ octree::octree(float points[], size_t np, double range[], int nMin)
   
 
 }
+
+octree::~octree()
+{
+  delete_octree(octreeRoot);
+}
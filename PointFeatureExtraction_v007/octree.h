@@ -21,6 +21,7 @@ private:
 public:
   octreeNode *octreeRoot;
   octree(float points[], size_t np, double range[], int nMin);
+  ~octree();
 };
 
 #endif
@@ -0,0 +1,42 @@
+#ifndef _parallelSortKeys_H__
+#define _parallelSortKeys_H__
+
+#include <vector>
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+//--- Sort of ( key, index ) pairs shared by pfe ( duplicate removal, Morton order ) and pds
+//    Each thread sorts one block, then blocks are merged pairwise.
+template <class KeyIndex>
+void parallelSortKeys( std::vector<KeyIndex> &keys )
+{
+  int numBlocks = 1;
+#ifdef _OPENMP
+  numBlocks = omp_get_max_threads();
+#endif
+  size_t num = keys.size();
+  std::vector<size_t> bound( numBlocks + 1 );
+  for( int t = 0; t <= numBlocks; t++ )
+    bound[t] = num * t / numBlocks;
+
+#pragma omp parallel for
+  for( int t = 0; t < numBlocks; t++ )
+    std::sort( keys.begin() + bound[t], keys.begin() + bound[t+1] );
+
+  for( int width = 1; width < numBlocks; width *= 2 ) {
+#pragma omp parallel for
+    for( int t = 0; t < numBlocks; t += 2 * width ) {
+      if( t + width < numBlocks ) {
+        int end = std::min( t + 2 * width, numBlocks );
+        std::inplace_merge( keys.begin() + bound[t],
+                            keys.begin() + bound[t + width],
+                            keys.begin() + bound[end] );
+      }
+    }
+  }
+}
+
+#endif
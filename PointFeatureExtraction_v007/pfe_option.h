@@ -0,0 +1,23 @@
+#ifndef _pfe_option_H__
+#define _pfe_option_H__
+
+const char NORMAL_ESTIMATION_OPTION[] = "-n";
+const char VIEWPOINT_OPTION[]         = "-vp";
+const char PLANE_SEGMENTATION_OPTION[] = "-ps";
+const char DUPLICATE_REMOVAL_OPTION[]  = "-dd";
+const char AUTO_RADIUS_OPTION[]        = "-ar";
+const char PREVIEW_STRIDE_OPTION[]     = "-pv";
+const char PREVIEW_FRACTION_OPTION[]   = "-pvr";
+const char FEATURE_EXPRESSION_OPTION[] = "-fx";
+const char INCREMENTAL_OPTION[]        = "-inc";
+const char ROI_BOX_OPTION[]            = "-roi";
+const char ROI_INDEX_OPTION[]          = "-roii";
+const char EIGEN_CACHE_OPTION[]        = "-ec";
+const char CHECKPOINT_OPTION[]         = "-cp";
+const char OUT_OF_CORE_OPTION[]        = "-oc";
+const char NUM_PROCESSES_OPTION[]      = "-np";
+const char OUT_OF_CORE_WORKER_OPTION[] = "-ocw";
+const char MORTON_ORDER_OPTION[]       = "-mo";
+const char MORTON_KEEP_OPTION[]        = "-mok";
+
+#endif
@@ -1,5 +1,6 @@
 #include <kvs/PolygonImporter>
 #include "plyRead.h"
+#include "asciiPointParser.h"
 #include <fstream>
 #include <cstring>
 
@@ -120,74 +121,27 @@ void plyRead::checkHasFace( void )
 void plyRead::execReadAscii( char* filename)
 {
   std::cout << "ASCII Data " << std::endl;
-  std::ifstream fin( m_filename );
-  if( !fin ) {
-    std::cerr << "ERROR: Cannot Open ;" << m_filename << std::endl;
-    exit(1);
-  }
-  //--- Skip Header
-  char buf[BUF_SIZE];
-  while( fin.getline( buf, BUF_SIZE, '\n' ) ) 
-    if( !strncmp( buf, "end_header", 10 ) ){ 
-      break;
-    }  
-  std::vector<kvs::Real32> coords; 
-  std::vector<kvs::Real32> normals;
-  std::vector<kvs::UInt8>  colors;  
-  float p[3];
-  float np[3];
-  unsigned char c[3];
-  int slide = 0;
-  char words[ 20 ][BUF_SIZE];
-  char *ps;
-  int numT;
-  kvs::Vector3f minCoord( 1.0e6, 1.0e6, 1.0e6 );
-  kvs::Vector3f maxCoord( -1.0e6, -1.0e6, -1.0e6 );
-  //--- Reading Data
-  while( fin.getline( buf, BUF_SIZE, '\n' ) ) {
-    numT = 0;
-    ps = buf;
-    //--- Devide Token
-    while( (ps=strtok(ps, " \t") ) !=NULL ) {
-      strcpy( words[numT], ps );
-      numT++;
-      ps = NULL;
-    }
-    p[0] = atof( words[0] );
-    p[1] = atof( words[1] );
-    p[2] = atof( words[2] );
-    coords.push_back( p[0] );
-    coords.push_back( p[1] );
-    coords.push_back( p[2] );
-    if( minCoord.x() > p[0] ) minCoord[0] = p[0];
-    if( minCoord.y() > p[1] ) minCoord[1] = p[1];
-    if( minCoord.z() > p[2] ) minCoord[2] = p[2];
-    if( maxCoord.x() < p[0] ) maxCoord[0] = p[0];
-    if( maxCoord.y() < p[1] ) maxCoord[1] = p[1];
-    if( maxCoord.z() < p[2] ) maxCoord[2] = p[2];
-    if( hasNormal ) {
-      np[0] = atof( words[3] );
-      np[1] = atof( words[4] );
-      np[2] = atof( words[5] );
-      normals.push_back( np[0] );
-      normals.push_back( np[1] );
-      normals.push_back( np[2] );
-      slide = 3;
-    }    
-    if( hasColor ) {
-      c[0] = static_cast<unsigned char>( atoi( words[ slide + 3 ] ) );
-      c[1] = static_cast<unsigned char>( atoi( words[ slide + 4 ] ) );
-      c[2] = static_cast<unsigned char>( atoi( words[ slide + 5 ] ) );
-      colors.push_back( c[0] );      
-      colors.push_back( c[1] );      
-      colors.push_back( c[2] );      
-    }
-  }
-  //  std::cout << "min: " << minCoord << " max: " << maxCoord <<std::endl;
-  SuperClass::setCoords( kvs::ValueArray<kvs::Real32>( coords ));
-  SuperClass::setColors( kvs::ValueArray<kvs::UInt8>( colors ) );
-  SuperClass::setNormals( kvs::ValueArray<kvs::Real32>(normals ) );
-  SuperClass::setMinMaxObjectCoords( minCoord, maxCoord );
+  //--- Vertex lines after the header, parsed in parallel
+  asciiPointParser parser( m_filename );
+  size_t num = parser.countPoints( parser.lineAfter( "end_header" ), numVert );
+
+  kvs::ValueArray<kvs::Real32> coords( 3 * num );
+  kvs::ValueArray<kvs::Real32> normals( hasNormal ? 3 * num : 0 );
+  kvs::ValueArray<kvs::UInt8>  colors( hasColor ? 3 * num : 0 );
+
+  int slide = hasNormal ? 3 : 0;
+  asciiPointParser::Layout layout = { 0, hasNormal ? 3 : -1, hasColor ? slide + 3 : -1, -1, 3,
+                                      { 0.0f, 0.0f, 0.0f }, { 0, 0, 0 }, 0.0f };
+  asciiPointParser::PointArrays arrays = { coords.data(),
+                                           hasNormal ? normals.data() : NULL,
+                                           hasColor ? colors.data() : NULL,
+                                           NULL };
+  parser.parsePoints( layout, arrays );
+
+  SuperClass::setCoords( coords );
+  SuperClass::setColors( colors );
+  SuperClass::setNormals( normals );
+  SuperClass::updateMinMaxCoords();
   
 }
 
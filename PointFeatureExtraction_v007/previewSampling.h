@@ -0,0 +1,63 @@
+#ifndef _previewSampling_H__
+#define _previewSampling_H__
+
+#include <kvs/PolygonObject>
+#include <kvs/MersenneTwister>
+#include <vector>
+
+//--- Points of the preview: every stride-th point ( stride > 1 ),
+//    or a random fraction of the points ( 0 < fraction < 1 )
+std::vector<size_t> selectPreviewPoints( size_t num, int stride, double fraction )
+{
+  std::vector<size_t> index;
+  if( stride > 1 ) {
+    index.reserve( num / stride + 1 );
+    for( size_t i = 0; i < num; i += stride )
+      index.push_back( i );
+  }
+  else {
+    kvs::MersenneTwister uniRand;
+    index.reserve( (size_t)( num * fraction ) + 1 );
+    for( size_t i = 0; i < num; i++ )
+      if( uniRand() < fraction )
+        index.push_back( i );
+  }
+  return index;
+}
+
+//--- Copy of the preview points ( coordinates, normals and colors )
+kvs::PolygonObject* extractPreviewPoints( kvs::PolygonObject *ply,
+                                          const std::vector<size_t> &index )
+{
+  size_t num = ply->numberOfVertices();
+  size_t numPreview = index.size();
+  bool hasNormal = ( num == ply->numberOfNormals() );
+  bool hasColor  = ( num == ply->numberOfColors() );
+  kvs::ValueArray<kvs::Real32> coords  = ply->coords();
+  kvs::ValueArray<kvs::Real32> normals = ply->normals();
+  kvs::ValueArray<kvs::UInt8>  colors  = ply->colors();
+
+  kvs::ValueArray<kvs::Real32> previewCoords( 3 * numPreview );
+  kvs::ValueArray<kvs::Real32> previewNormals( hasNormal ? 3 * numPreview : 0 );
+  kvs::ValueArray<kvs::UInt8>  previewColors( hasColor ? 3 * numPreview : 0 );
+  for( size_t j = 0; j < numPreview; j++ ) {
+    size_t i = index[j];
+    for( int k = 0; k < 3; k++ ) {
+      previewCoords[3*j+k] = coords[3*i+k];
+      if( hasNormal ) previewNormals[3*j+k] = normals[3*i+k];
+      if( hasColor )  previewColors[3*j+k]  = colors[3*i+k];
+    }
+  }
+
+  kvs::PolygonObject *preview = new kvs::PolygonObject();
+  preview->setPolygonType( kvs::PolygonObject::UnknownPolygonType );
+  preview->setColorType( kvs::PolygonObject::VertexColor );
+  preview->setNormalType( kvs::PolygonObject::VertexNormal );
+  preview->setCoords( previewCoords );
+  preview->setNormals( previewNormals );
+  preview->setColors( previewColors );
+  preview->updateMinMaxCoords();
+  return preview;
+}
+
+#endif
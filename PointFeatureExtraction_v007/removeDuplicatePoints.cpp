@@ -0,0 +1,165 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#include "removeDuplicatePoints.h"
+#include "parallelSortKeys.h"
+
+const int DD_KEY_BITS = 21;                                     // Bits per axis of a cell key
+const unsigned long long DD_KEY_MAX = ( 1ULL << DD_KEY_BITS );  // Maximum number of cells per axis
+
+removeDuplicatePoints::removeDuplicatePoints( void ):
+  m_tolerance( 0.0 )
+{  }
+
+removeDuplicatePoints::removeDuplicatePoints( kvs::PolygonObject* ply,
+                                              double tolerance ):
+  m_tolerance( tolerance )
+{
+  SuperClass::setPolygonType( kvs::PolygonObject::UnknownPolygonType );
+  SuperClass::setColorType( kvs::PolygonObject::VertexColor );
+  SuperClass::setNormalType( kvs::PolygonObject::VertexNormal );
+
+  exec( ply );
+}
+
+//--- Values of the merged points ( dim per point ) -> values of the input points
+std::vector<float> removeDuplicatePoints::restoreOrder( const std::vector<float> &values, size_t dim )
+{
+  size_t num = m_indexMap.size();
+  std::vector<float> restored( dim * num, 0.0f );
+  if( values.size() != dim * SuperClass::numberOfVertices() )
+    return restored;
+
+#pragma omp parallel for
+  for( long i = 0; i < (long)num; i++ ) {
+    for( size_t k = 0; k < dim; k++ )
+      restored[dim*i+k] = values[dim*m_indexMap[i]+k];
+  }
+  return restored;
+}
+
+void removeDuplicatePoints::exec( kvs::PolygonObject* ply )
+{
+  size_t numVert = ply->numberOfVertices();
+  if( numVert == 0 || m_tolerance < 0.0 ) {
+    std::cout << "ERROR: Invalid input for duplicate-point removal" << std::endl;
+    exit(1);
+  }
+  bool hasNormal = ( ply->numberOfNormals() == numVert );
+  bool hasColor  = ( ply->numberOfColors() == numVert );
+
+  kvs::ValueArray<kvs::Real32> coords  = ply->coords();
+  kvs::ValueArray<kvs::Real32> normals = ply->normals();
+  kvs::ValueArray<kvs::UInt8>  colors  = ply->colors();
+  const float *pcoords = coords.data();
+
+  //--- Bounding box
+  float minX = pcoords[0], minY = pcoords[1], minZ = pcoords[2];
+  float maxX = pcoords[0], maxY = pcoords[1], maxZ = pcoords[2];
+#pragma omp parallel for reduction(min:minX,minY,minZ) reduction(max:maxX,maxY,maxZ)
+  for( long i = 0; i < (long)numVert; i++ ) {
+    minX = std::min( minX, pcoords[3*i] );
+    minY = std::min( minY, pcoords[3*i+1] );
+    minZ = std::min( minZ, pcoords[3*i+2] );
+    maxX = std::max( maxX, pcoords[3*i] );
+    maxY = std::max( maxY, pcoords[3*i+1] );
+    maxZ = std::max( maxZ, pcoords[3*i+2] );
+  }
+  if( m_tolerance > 0.0 ) {
+    double dimension[3] = { ( maxX - minX ) / m_tolerance,
+                            ( maxY - minY ) / m_tolerance,
+                            ( maxZ - minZ ) / m_tolerance };
+    for( int k = 0; k < 3; k++ ) {
+      if( dimension[k] >= (double)( DD_KEY_MAX - 1 ) ) {
+        std::cout << "ERROR: Duplicate tolerance is too small ( more than "
+                  << DD_KEY_MAX - 1 << " cells per axis )" << std::endl;
+        exit(1);
+      }
+    }
+  }
+
+  //--- Key of each point
+  //    tolerance > 0 : cell of size tolerance
+  //    tolerance = 0 : bit patterns of the coordinates
+  std::cout << "Calculating duplicate keys..." << std::endl;
+  std::vector<KeyIndex> keys( numVert );
+  float origin[3] = { minX, minY, minZ };
+#pragma omp parallel for
+  for( long i = 0; i < (long)numVert; i++ ) {
+    unsigned int c[3];
+    for( int k = 0; k < 3; k++ ) {
+      if( m_tolerance > 0.0 ) {
+        c[k] = (unsigned int)( ( pcoords[3*i+k] - origin[k] ) / m_tolerance );
+      }
+      else {
+        float x = pcoords[3*i+k] + 0.0f;   // -0 -> +0
+        memcpy( &c[k], &x, sizeof(unsigned int) );
+      }
+    }
+    keys[i].first.first  = ( (unsigned long long)c[0] << 32 ) | c[1];
+    keys[i].first.second = c[2];
+    keys[i].second = i;
+  }
+
+  std::cout << "Sorting duplicate keys..." << std::endl;
+  parallelSortKeys( keys );
+
+  //--- First entry of each group
+  std::vector<size_t> groupStart;
+  for( size_t i = 0; i < numVert; i++ ) {
+    if( i == 0 || keys[i].first != keys[i-1].first )
+      groupStart.push_back( i );
+  }
+  size_t numGroup = groupStart.size();
+  groupStart.push_back( numVert );
+
+  //--- Merge attributes per group
+  std::cout << "Merging duplicate points..." << std::endl;
+  kvs::ValueArray<kvs::Real32> mergedCoords( 3 * numGroup );
+  kvs::ValueArray<kvs::Real32> mergedNormals( hasNormal ? 3 * numGroup : 0 );
+  kvs::ValueArray<kvs::UInt8>  mergedColors( hasColor ? 3 * numGroup : 0 );
+  m_indexMap.assign( numVert, 0 );
+
+#pragma omp parallel for schedule(dynamic, 1024)
+  for( long g = 0; g < (long)numGroup; g++ ) {
+    double p[3] = { 0.0, 0.0, 0.0 };
+    double n[3] = { 0.0, 0.0, 0.0 };
+    double c[3] = { 0.0, 0.0, 0.0 };
+    size_t begin = groupStart[g];
+    size_t end   = groupStart[g+1];
+    for( size_t j = begin; j < end; j++ ) {
+      size_t id = keys[j].second;
+      m_indexMap[id] = g;
+      for( int k = 0; k < 3; k++ ) {
+        p[k] += pcoords[3*id+k];
+        if( hasNormal ) n[k] += normals[3*id+k];
+        if( hasColor )  c[k] += colors[3*id+k];
+      }
+    }
+    double inv = 1.0 / (double)( end - begin );
+    for( int k = 0; k < 3; k++ )
+      mergedCoords[3*g+k] = (kvs::Real32)( p[k] * inv );
+    if( hasNormal ) {
+      double len = sqrt( n[0]*n[0] + n[1]*n[1] + n[2]*n[2] );
+      if( len > 0.0 ) len = 1.0 / len;
+      for( int k = 0; k < 3; k++ )
+        mergedNormals[3*g+k] = (kvs::Real32)( n[k] * len );
+    }
+    if( hasColor ) {
+      for( int k = 0; k < 3; k++ )
+        mergedColors[3*g+k] = (kvs::UInt8)( c[k] * inv + 0.5 );
+    }
+  }
+
+  SuperClass::setCoords( mergedCoords );
+  SuperClass::setNormals( mergedNormals );
+  SuperClass::setColors( mergedColors );
+  SuperClass::updateMinMaxCoords();
+
+  std::cout << "Duplicate tolerance : " << m_tolerance << std::endl;
+  std::cout << "Number of points    : " << numVert << " -> " << numGroup
+            << " ( " << numVert - numGroup << " duplicates removed )" << std::endl;
+}
@@ -0,0 +1,37 @@
+#ifndef _removeDuplicatePoints_H__
+#define _removeDuplicatePoints_H__
+
+#include <kvs/Module>
+#include <kvs/PolygonObject>
+#include <vector>
+#include <utility>
+
+//--- Removal of coincident points before octree construction
+//    Coordinates are quantized with the tolerance ( tolerance 0: exactly
+//    equal coordinates ) and points with the same key are merged into one
+//    point with averaged attributes. The index map keeps the merged point of
+//    every input point, so that results can be restored to the input order.
+class removeDuplicatePoints: public kvs::PolygonObject {
+  kvsModuleSuperClass( kvs::PolygonObject );
+
+ public:
+  typedef std::pair< std::pair<unsigned long long, unsigned int>, size_t > KeyIndex;
+
+  removeDuplicatePoints( void );
+  removeDuplicatePoints( kvs::PolygonObject* ply, double tolerance );
+
+  std::vector<float> restoreOrder( const std::vector<float> &values, size_t dim );
+
+ private:
+  void exec( kvs::PolygonObject* ply );
+
+ private:
+  double m_tolerance;
+  std::vector<size_t> m_indexMap;   // Input point -> merged point
+
+ public:
+  double tolerance( void ) { return m_tolerance; }
+  const std::vector<size_t>& indexMap( void ) { return m_indexMap; }
+};
+
+#endif
@@ -13,6 +13,7 @@
 #include "spcomment.h"
 #include "spbr.h"
 #include "single_inputfile.h"
+#include "asciiPointParser.h"
 
 //#define DEBUG
 //#define DEBUG_COLOR
@@ -458,10 +459,12 @@ SPBR::readPointData( void )
       }
 
       // Scan position, normal vector, and color from the read line
-      double x  = 0.0, y  = 0.0, z  = 0.0 ;
-      double nx = 0.0, ny = 0.0, nz = 0.0 ;
-      unsigned int  Rb = m_Rb, Gb = m_Gb, Bb = m_Bb ;
-      int num_buf_words = sscanf ( buf, "%lg %lg %lg %lg %lg %lg %u %u %u", &x, &y, &z, &nx, &ny, &nz, &Rb, &Gb, &Bb );
+      //   ( shared number parser: the same values as %lg, words after a 9th are ignored )
+      double value[9] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, (double)m_Rb, (double)m_Gb, (double)m_Bb };
+      int num_buf_words = asciiPointParser::parseLine( buf, buf + strlen( buf ), value, 9 );
+      double x  = value[0], y  = value[1], z  = value[2] ;
+      double nx = value[3], ny = value[4], nz = value[5] ;
+      unsigned int  Rb = (unsigned int)(long)value[6], Gb = (unsigned int)(long)value[7], Bb = (unsigned int)(long)value[8] ;
 
 #if defined DEBUG_COLOR
       std::cout << "### num_buf_words = " << num_buf_words << std::endl;
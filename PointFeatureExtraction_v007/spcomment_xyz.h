@@ -20,5 +20,25 @@ const char XYZ_N [] = "XYZNormal" ;
 const char XYZ_NC [] = "XYZNormalColor" ;  
 //--- Datatype : Vertex + Normal + Color + Feature
 const char XYZ_NCF [] = "XYZNormalColorFeature" ;
+//--- Datatype : Vertex + Features at K radii
+const char XYZ_MSF [] = "XYZMultiScaleFeature" ;
+
+//---- Number of feature channels and their radii ( XYZMultiScaleFeature )
+const char XYZ_NUM_SCALES [] = "#/NumScales" ;
+const char XYZ_SCALE_RADII [] = "#/ScaleRadii" ;
+
+//---- Feature statistics written by pfe ( feature values normalized to [0, 1] )
+// #/FeatureBins  [number of histogram bins]
+const char XYZ_FEATURE_BINS [] = "#/FeatureBins" ;
+// #/FeatureHistogram  [first bin] [count] ... ( up to 8 bins per line )
+const char XYZ_FEATURE_HISTOGRAM [] = "#/FeatureHistogram" ;
+// #/FeatureQuantiles  [p] [quantile] ...
+const char XYZ_FEATURE_QUANTILES [] = "#/FeatureQuantiles" ;
+// #/FeatureRadius  [local-area radius] ( Point PCA )
+const char XYZ_FEATURE_RADIUS [] = "#/FeatureRadius" ;
+// #/FeatureValueID  [feature value type] ( Point PCA without a feature expression )
+const char XYZ_FEATURE_VALUE_ID [] = "#/FeatureValueID" ;
+// #/FeatureMaximum  [maximum before the normalization] ( Point PCA )
+const char XYZ_FEATURE_MAXIMUM [] = "#/FeatureMaximum" ;
 
 #endif
@@ -0,0 +1,843 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cerrno>
+#include <ctime>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <utime.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <sys/wait.h>
+
+#include <kvs/PolygonObject>
+
+#include "tiledFeatureExtraction.h"
+#include "xyzPointStream.h"
+#include "featureStatistics.h"
+#include "featureExpression.h"
+#include "pfe_option.h"
+
+const double BYTES_PER_TILE_POINT = 128.0;   // Tile point in memory ( object, octree, features )
+const int TILE_GRID_RESOLUTION    = 256;     // Cells along the longest side of the bounding box
+const double TILE_MAX_CELLS       = 2097152; // Cells of the count grid
+const double HALO_MARGIN          = 1.001;   // Halo width / local-area radius
+const size_t TILE_MIN_BUFFER      = 1024;    // Spill buffer of a tile ( points )
+const size_t MERGE_CHUNK          = 4096;    // Result records read at once
+const unsigned int POLL_INTERVAL  = 1;       // Seconds between the checks of the coordinator
+const unsigned int CLAIM_HEARTBEAT = 10;     // Seconds between the updates of a claim file by its owner
+const unsigned int CLAIM_TIMEOUT  = 120;     // Seconds without an update after which a claim is stale
+
+const char TILE_JOBS[]                 = "#/PFE_TileJobs";
+const char TILE_JOB_NUM_TILES[]        = "#/NumTiles";
+const char TILE_JOB_RADIUS[]           = "#/Radius";
+const char TILE_JOB_FEATURE_VALUE_ID[] = "#/FeatureValueID";
+const char TILE_JOB_EXPRESSION[]       = "#/FeatureExpression";
+const char TILE_JOB_END_HEADER[]       = "#/EndHeader";
+
+//--- Point in a spill file ( in the input order within a tile )
+struct TilePoint
+{
+  float p[3];
+  float n[3];
+  unsigned long long index;
+  unsigned char c[3];
+  unsigned char isCore;
+};
+
+//--- Raw feature of a core point ( in the input order within a tile )
+//    A result file has the raw maximum of the tile ( double ) followed by the records.
+struct TileResult
+{
+  unsigned long long index;
+  float value;
+};
+
+static void flushTile( const std::string &filename, std::vector<TilePoint> &buffer, char &isStarted )
+{
+  std::ios::openmode mode = std::ios::binary | ( isStarted ? std::ios::app : std::ios::trunc );
+  std::ofstream fout( filename.c_str(), mode );
+  if( !fout ) {
+    std::cout << "ERROR: Cannot write " << filename << std::endl;
+    exit(1);
+  }
+  fout.write( (char*)&buffer[0], sizeof(TilePoint) * buffer.size() );
+  buffer.clear();
+  isStarted = 1;
+}
+
+//--- The claim file of a tile is touched while the tile is computed, so that the
+//    coordinator can tell a live claim of another host from one of a stopped process
+class claimHeartbeat {
+ public:
+  claimHeartbeat( const std::string &filename ):
+    m_filename( filename ),
+    m_isComputing( true ),
+    m_thread( &claimHeartbeat::run, this )
+  {  }
+
+  ~claimHeartbeat( void )
+  {
+    {
+      std::lock_guard<std::mutex> lock( m_mutex );
+      m_isComputing = false;
+    }
+    m_stopped.notify_one();
+    m_thread.join();
+  }
+
+ private:
+  void run( void )
+  {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    while( !m_stopped.wait_for( lock, std::chrono::seconds( CLAIM_HEARTBEAT ),
+                                [this]{ return !m_isComputing; } ) )
+      utime( m_filename.c_str(), NULL );
+  }
+
+  std::string m_filename;
+  bool m_isComputing;
+  std::mutex m_mutex;
+  std::condition_variable m_stopped;
+  std::thread m_thread;
+};
+
+tiledFeatureExtraction::tiledFeatureExtraction( char* inputFile, char* outputFile, double budgetMB ):
+  m_inputFile( inputFile ),
+  m_outputFile( outputFile ),
+  m_budget( (size_t)( budgetMB * 1024.0 * 1024.0 ) ),
+  m_number( 0 ),
+  m_haloWidth( 0.0 ),
+  m_cellSize( 0.0 ),
+  m_numTiles( 0 ),
+  m_maxFeature( 0.0 ),
+  m_numWorkers( 0 )
+{
+  m_maxTilePoints = std::max( (size_t)1, (size_t)( m_budget / BYTES_PER_TILE_POINT ) );
+
+  char host[256];
+  if( gethostname( host, sizeof(host) ) != 0 )
+    strcpy( host, "localhost" );
+  host[ sizeof(host) - 1 ] = '\0';
+  m_host = host;
+}
+
+void tiledFeatureExtraction::setWorkers( int numWorkers, const char* program )
+{
+  m_numWorkers = std::max( 0, numWorkers );
+  m_program = program;
+}
+
+void tiledFeatureExtraction::exec( calculateFeature *ft )
+{
+  std::cout << "Out-of-core: memory budget " << m_budget / ( 1024 * 1024 ) << " MB ( "
+            << m_maxTilePoints << " points per tile with its halo )" << std::endl;
+
+  scanBoundingBox();
+
+  double highlight_precision_inv;
+  std::cout << "Highlighting precision" << std::endl;
+  std::cout << "Input 1/local-area_radius (recommend range [100-600]) >> ";
+  std::cin >> highlight_precision_inv;
+  ft->setSearchRadius( highlight_precision_inv,
+                       kvs::Vector3f( m_min[0], m_min[1], m_min[2] ),
+                       kvs::Vector3f( m_max[0], m_max[1], m_max[2] ) );
+  ft->setFixedSearchRadius( true );
+  ft->setNormalization( false );
+  std::cout << "Local-area radius = " << ft->searchRadius() << std::endl;
+  std::cout << std::endl;
+
+  countCells( ft->searchRadius() );
+  m_numTiles = (int)m_tileCore.size();
+  m_claimTime.assign( m_numTiles, 0 );
+  m_claimSeen.assign( m_numTiles, 0 );
+  distributePoints();
+  if( m_numWorkers > 0 )
+    runWorkers( ft );
+  else
+    computeTiles( ft, true );
+  mergeFeatures( ft->searchRadius(), ( ft->expression() == NULL ) ? (int)ft->featureValueID() : -1 );
+  removeWorkFiles();
+}
+
+//--- Worker of a sharded run: the tiles of the job file that no one has claimed
+void tiledFeatureExtraction::execWorker( calculateFeature *ft )
+{
+  readJobFile( ft );
+  std::cout << "Out-of-core worker ( " << m_host << " " << getpid() << " ): "
+            << m_numTiles << " tiles, local-area radius = " << ft->searchRadius() << std::endl;
+  std::cout << std::endl;
+  computeTiles( ft, false );
+}
+
+std::string tiledFeatureExtraction::tileFileName( int tile )
+{
+  char buf[32];
+  snprintf( buf, sizeof(buf), ".tile%d", tile );
+  return std::string( m_outputFile ) + buf;
+}
+
+std::string tiledFeatureExtraction::claimFileName( int tile )
+{
+  return tileFileName( tile ) + ".claim";
+}
+
+std::string tiledFeatureExtraction::resultFileName( int tile )
+{
+  return tileFileName( tile ) + ".result";
+}
+
+std::string tiledFeatureExtraction::jobFileName( void )
+{
+  return std::string( m_outputFile ) + ".jobs";
+}
+
+std::string tiledFeatureExtraction::workerLogName( int worker )
+{
+  char buf[32];
+  snprintf( buf, sizeof(buf), ".worker%d.log", worker );
+  return std::string( m_outputFile ) + buf;
+}
+
+//--- Pass 1: number of points and bounding box
+void tiledFeatureExtraction::scanBoundingBox( void )
+{
+  xyzPointStream in( m_inputFile );
+  float p[3], n[3];
+  unsigned char c[3];
+  m_number = 0;
+  while( in.next( p, n, c ) ) {
+    for( int k = 0; k < 3; k++ ) {
+      if( m_number == 0 || p[k] < m_min[k] ) m_min[k] = p[k];
+      if( m_number == 0 || p[k] > m_max[k] ) m_max[k] = p[k];
+    }
+    m_number++;
+  }
+  if( m_number == 0 ) {
+    std::cout << "ERROR: No points in " << m_inputFile << std::endl;
+    exit(1);
+  }
+  std::cout << "Number of points: " << m_number << std::endl;
+  std::cout << "Min : " << m_min[0] << " " << m_min[1] << " " << m_min[2] << std::endl;
+  std::cout << "Max : " << m_max[0] << " " << m_max[1] << " " << m_max[2] << std::endl;
+}
+
+void tiledFeatureExtraction::cellIndex( const float p[3], int c[3] )
+{
+  for( int k = 0; k < 3; k++ ) {
+    c[k] = (int)( ( p[k] - m_min[k] ) / m_cellSize );
+    c[k] = std::max( 0, std::min( m_numCells[k] - 1, c[k] ) );
+  }
+}
+
+//--- Points in the cells [lo, hi) ( summed-area table )
+unsigned long long tiledFeatureExtraction::boxCount( const int lo[3], const int hi[3] )
+{
+  size_t ny = m_numCells[1] + 1, nz = m_numCells[2] + 1;
+  #define SUM( i, j, k ) m_cellSum[ ( (size_t)(i) * ny + (j) ) * nz + (k) ]
+  return SUM( hi[0], hi[1], hi[2] ) - SUM( lo[0], hi[1], hi[2] ) - SUM( hi[0], lo[1], hi[2] )
+       - SUM( hi[0], hi[1], lo[2] ) + SUM( lo[0], lo[1], hi[2] ) + SUM( lo[0], hi[1], lo[2] )
+       + SUM( hi[0], lo[1], lo[2] ) - SUM( lo[0], lo[1], lo[2] );
+  #undef SUM
+}
+
+//--- Pass 2: point counts of the grid cells, and the tiles
+void tiledFeatureExtraction::countCells( double radius )
+{
+  m_haloWidth = radius * HALO_MARGIN;
+  double maxExtent = 0.0;
+  for( int k = 0; k < 3; k++ )
+    maxExtent = std::max( maxExtent, (double)( m_max[k] - m_min[k] ) );
+
+  //--- Cells not smaller than the radius, and not too many
+  m_cellSize = std::max( radius, maxExtent / TILE_GRID_RESOLUTION );
+  if( m_cellSize <= 0.0 )
+    m_cellSize = 1.0;
+  for(;;) {
+    double numCells = 1.0;
+    for( int k = 0; k < 3; k++ ) {
+      m_numCells[k] = std::max( 1, (int)ceil( ( m_max[k] - m_min[k] ) / m_cellSize ) );
+      numCells *= m_numCells[k];
+    }
+    if( numCells <= TILE_MAX_CELLS )
+      break;
+    m_cellSize *= 1.25;
+  }
+
+  size_t ny = m_numCells[1] + 1, nz = m_numCells[2] + 1;
+  m_cellSum.assign( ( m_numCells[0] + 1 ) * ny * nz, 0 );
+
+  xyzPointStream in( m_inputFile );
+  float p[3], n[3];
+  unsigned char c[3];
+  int cell[3];
+  while( in.next( p, n, c ) ) {
+    cellIndex( p, cell );
+    m_cellSum[ ( (size_t)( cell[0] + 1 ) * ny + cell[1] + 1 ) * nz + cell[2] + 1 ]++;
+  }
+
+  //--- Prefix sums along each axis
+  for( int i = 1; i <= m_numCells[0]; i++ )
+    for( size_t j = 0; j < ny; j++ )
+      for( size_t k = 0; k < nz; k++ )
+        m_cellSum[ ( i * ny + j ) * nz + k ] += m_cellSum[ ( ( i - 1 ) * ny + j ) * nz + k ];
+  for( int i = 0; i <= m_numCells[0]; i++ )
+    for( size_t j = 1; j < ny; j++ )
+      for( size_t k = 0; k < nz; k++ )
+        m_cellSum[ ( i * ny + j ) * nz + k ] += m_cellSum[ ( i * ny + j - 1 ) * nz + k ];
+  for( int i = 0; i <= m_numCells[0]; i++ )
+    for( size_t j = 0; j < ny; j++ )
+      for( size_t k = 1; k < nz; k++ )
+        m_cellSum[ ( i * ny + j ) * nz + k ] += m_cellSum[ ( i * ny + j ) * nz + k - 1 ];
+
+  int lo[3] = { 0, 0, 0 };
+  buildTiles( lo, m_numCells );
+  std::cout << "Grid: " << m_numCells[0] << " x " << m_numCells[1] << " x " << m_numCells[2]
+            << " cells ( " << m_cellSize << " ), " << m_tileCore.size() << " tiles" << std::endl;
+  std::cout << std::endl;
+}
+
+//--- Split the cells [lo, hi) at the median of their points along the longest axis
+//    until the tile and its halo fit in the budget ( a single cell is not split )
+int tiledFeatureExtraction::buildTiles( const int lo[3], const int hi[3] )
+{
+  int node = (int)m_nodes.size();
+  KdNode leaf = { -1, 0, 0.0, { -1, -1 }, -1 };
+  m_nodes.push_back( leaf );
+
+  int h = std::max( 1, (int)ceil( m_haloWidth / m_cellSize ) );
+  int elo[3], ehi[3];
+  int axis = 0;
+  for( int k = 0; k < 3; k++ ) {
+    elo[k] = std::max( 0, lo[k] - h );
+    ehi[k] = std::min( m_numCells[k], hi[k] + h );
+    if( hi[k] - lo[k] > hi[axis] - lo[axis] )
+      axis = k;
+  }
+  unsigned long long core  = boxCount( lo, hi );
+  unsigned long long total = boxCount( elo, ehi );
+
+  if( total <= m_maxTilePoints || hi[axis] - lo[axis] <= 1 || core == 0 ) {
+    if( total > m_maxTilePoints && core > 0 )
+      std::cout << "Tile " << m_tileCore.size() << " exceeds the memory budget ( "
+                << total << " points with the halo )" << std::endl;
+    m_nodes[node].tile = (int)m_tileCore.size();
+    m_tileCore.push_back( core );
+    return node;
+  }
+
+  int split = lo[axis] + 1;
+  int slabHi[3] = { hi[0], hi[1], hi[2] };
+  for( ; split < hi[axis] - 1; split++ ) {
+    slabHi[axis] = split;
+    if( 2 * boxCount( lo, slabHi ) >= core )
+      break;
+  }
+
+  int leftHi[3]  = { hi[0], hi[1], hi[2] };
+  int rightLo[3] = { lo[0], lo[1], lo[2] };
+  leftHi[axis]  = split;
+  rightLo[axis] = split;
+  int left  = buildTiles( lo, leftHi );
+  int right = buildTiles( rightLo, hi );
+
+  m_nodes[node].axis       = axis;
+  m_nodes[node].split      = split;
+  m_nodes[node].splitCoord = m_min[axis] + split * m_cellSize;
+  m_nodes[node].child[0]   = left;
+  m_nodes[node].child[1]   = right;
+  return node;
+}
+
+//--- Tiles whose core or halo contains p; returns the tile of the core
+int tiledFeatureExtraction::findTiles( const float p[3], std::vector<int> &tiles )
+{
+  int cell[3];
+  cellIndex( p, cell );
+
+  int owner = 0;
+  while( m_nodes[owner].axis >= 0 )
+    owner = m_nodes[owner].child[ cell[ m_nodes[owner].axis ] < m_nodes[owner].split ? 0 : 1 ];
+
+  tiles.clear();
+  std::vector<int> stack( 1, 0 );
+  while( !stack.empty() ) {
+    const KdNode &node = m_nodes[ stack.back() ];
+    stack.pop_back();
+    if( node.axis < 0 ) {
+      tiles.push_back( node.tile );
+      continue;
+    }
+    bool isLeft = ( cell[node.axis] < node.split );
+    if( isLeft || p[node.axis] < node.splitCoord + m_haloWidth )
+      stack.push_back( node.child[0] );
+    if( !isLeft || p[node.axis] >= node.splitCoord - m_haloWidth )
+      stack.push_back( node.child[1] );
+  }
+  return m_nodes[owner].tile;
+}
+
+//--- Pass 3: spill files of the tiles ( core points and halo points )
+void tiledFeatureExtraction::distributePoints( void )
+{
+  size_t numTiles = m_tileCore.size();
+  size_t bufferPoints = std::max( TILE_MIN_BUFFER, m_budget / 2 / sizeof(TilePoint) / numTiles );
+  std::vector< std::vector<TilePoint> > buffers( numTiles );
+  std::vector<char> isStarted( numTiles, 0 );
+  std::vector<int> tiles;
+
+  //--- Claims and results of an earlier run
+  for( size_t t = 0; t < numTiles; t++ ) {
+    std::remove( claimFileName( t ).c_str() );
+    std::remove( resultFileName( t ).c_str() );
+  }
+
+  std::cout << "Writing the tiles..... " << std::endl;
+  xyzPointStream in( m_inputFile );
+  TilePoint tp;
+  unsigned long long index = 0;
+  while( in.next( tp.p, tp.n, tp.c ) ) {
+    tp.index = index++;
+    int owner = findTiles( tp.p, tiles );
+    for( size_t k = 0; k < tiles.size(); k++ ) {
+      int t = tiles[k];
+      if( m_tileCore[t] == 0 )
+        continue;
+      tp.isCore = ( t == owner );
+      buffers[t].push_back( tp );
+      if( buffers[t].size() >= bufferPoints )
+        flushTile( tileFileName( t ), buffers[t], isStarted[t] );
+    }
+  }
+  for( size_t t = 0; t < numTiles; t++ )
+    if( !buffers[t].empty() )
+      flushTile( tileFileName( t ), buffers[t], isStarted[t] );
+}
+
+//--- Raw features of the tiles that are not done
+//    isTakeOver = false ( worker ): only the tiles that no one has claimed
+//    isTakeOver = true  ( coordinator ): also the tiles claimed by stopped processes
+void tiledFeatureExtraction::computeTiles( calculateFeature *ft, bool isTakeOver )
+{
+  for( int t = 0; t < m_numTiles; t++ ) {
+    std::ifstream spill( tileFileName( t ).c_str(), std::ios::binary );
+    if( !spill )
+      continue;
+    spill.close();
+    if( isTileDone( t ) || !claimTile( t, isTakeOver ) || isTileDone( t ) )
+      continue;
+    computeTile( ft, t );
+  }
+}
+
+bool tiledFeatureExtraction::isTileDone( int tile )
+{
+  std::ifstream fin( resultFileName( tile ).c_str(), std::ios::binary );
+  return (bool)fin;
+}
+
+//--- A tile is claimed by creating its claim file ( atomic, also on a shared file system )
+bool tiledFeatureExtraction::claimTile( int tile, bool isTakeOver )
+{
+  std::string filename = claimFileName( tile );
+  for( int attempt = 0; attempt < 2; attempt++ ) {
+    int fd = open( filename.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644 );
+    if( fd >= 0 ) {
+      std::ostringstream owner;
+      owner << m_host << " " << getpid() << std::endl;
+      std::string text = owner.str();
+      ssize_t written = write( fd, text.c_str(), text.size() );
+      close( fd );
+      return written >= 0;
+    }
+    if( !isTakeOver || attempt > 0 )
+      return false;
+
+    //--- Claim of a stopped process: on this host, the process no longer exists;
+    //    otherwise, the owner has not touched the claim file for CLAIM_TIMEOUT
+    //    ( measured with the clock of this host, so the clocks need not agree )
+    std::ifstream fin( filename.c_str() );
+    std::string host;
+    long pid = 0;
+    fin >> host >> pid;
+    fin.close();
+    if( host == m_host && pid > 0 ) {
+      if( kill( (pid_t)pid, 0 ) == 0 || errno != ESRCH )
+        return false;
+      std::cout << "Tile " << tile << " of the stopped process " << pid << " is computed again" << std::endl;
+    }
+    else {
+      struct stat st;
+      if( stat( filename.c_str(), &st ) != 0 )
+        continue;
+      time_t now = time( NULL );
+      if( m_claimSeen[tile] == 0 || st.st_mtime != m_claimTime[tile] ) {
+        m_claimTime[tile] = st.st_mtime;
+        m_claimSeen[tile] = now;
+        return false;
+      }
+      if( now - m_claimSeen[tile] < (time_t)CLAIM_TIMEOUT )
+        return false;
+      std::cout << "Tile " << tile << " claimed by " << host << " " << pid << " ( " << filename
+                << " ) has not been updated for " << now - m_claimSeen[tile]
+                << " seconds and is computed again" << std::endl;
+    }
+    removeTempResults( tile );
+    std::remove( filename.c_str() );
+  }
+  return false;
+}
+
+//--- Result files of a tile left by a process stopped before the rename ( [result].tmp* )
+void tiledFeatureExtraction::removeTempResults( int tile )
+{
+  std::string prefix = resultFileName( tile ) + ".tmp";
+  std::string dir = ".";
+  std::string base = prefix;
+  size_t slash = prefix.rfind( '/' );
+  if( slash != std::string::npos ) {
+    dir  = prefix.substr( 0, slash + 1 );
+    base = prefix.substr( slash + 1 );
+  }
+
+  DIR *dp = opendir( dir.c_str() );
+  if( dp == NULL )
+    return;
+  struct dirent *entry;
+  while( ( entry = readdir( dp ) ) != NULL ) {
+    if( strncmp( entry->d_name, base.c_str(), base.size() ) != 0 )
+      continue;
+    std::string filename = ( slash != std::string::npos ) ? dir + entry->d_name : std::string( entry->d_name );
+    std::remove( filename.c_str() );
+  }
+  closedir( dp );
+}
+
+//--- Raw features of the core points of a tile ( result file renamed when complete )
+void tiledFeatureExtraction::computeTile( calculateFeature *ft, int t )
+{
+  claimHeartbeat heartbeat( claimFileName( t ) );
+
+  //--- Tile and its halo
+  std::string filename = tileFileName( t );
+  std::ifstream fin( filename.c_str(), std::ios::binary | std::ios::ate );
+  size_t num = (size_t)fin.tellg() / sizeof(TilePoint);
+  fin.seekg( 0 );
+  std::vector<TilePoint> points( num );
+  fin.read( (char*)&points[0], sizeof(TilePoint) * num );
+  fin.close();
+
+  std::vector<kvs::Real32> coords( 3 * num ), normals( 3 * num );
+  std::vector<kvs::UInt8> colors( 3 * num );
+  std::vector<size_t> core;
+  std::vector<unsigned long long> coreIndex;
+  for( size_t i = 0; i < num; i++ ) {
+    for( int k = 0; k < 3; k++ ) {
+      coords[3*i+k]  = points[i].p[k];
+      normals[3*i+k] = points[i].n[k];
+      colors[3*i+k]  = points[i].c[k];
+    }
+    if( points[i].isCore ) {
+      core.push_back( i );
+      coreIndex.push_back( points[i].index );
+    }
+  }
+  std::vector<TilePoint>().swap( points );
+
+  kvs::PolygonObject *tile = new kvs::PolygonObject();
+  tile->setPolygonType( kvs::PolygonObject::UnknownPolygonType );
+  tile->setColorType( kvs::PolygonObject::VertexColor );
+  tile->setNormalType( kvs::PolygonObject::VertexNormal );
+  tile->setCoords( kvs::ValueArray<kvs::Real32>( coords ) );
+  tile->setNormals( kvs::ValueArray<kvs::Real32>( normals ) );
+  tile->setColors( kvs::ValueArray<kvs::UInt8>( colors ) );
+  tile->updateMinMaxCoords();
+  std::vector<kvs::Real32>().swap( coords );
+  std::vector<kvs::Real32>().swap( normals );
+  std::vector<kvs::UInt8>().swap( colors );
+
+  std::cout << "Tile " << t + 1 << " / " << m_numTiles << " : " << core.size()
+            << " points ( " << num - core.size() << " halo points )" << std::endl;
+  ft->setPreviewPoints( core );
+  ft->calc( tile );
+  std::vector<float> raw = ft->releaseFeature();
+  double rawMax = ft->rawMaxFeature();
+  delete tile;
+
+  //--- Results in the input order within the tile
+  std::vector<TileResult> records( raw.size() );
+  for( size_t q = 0; q < raw.size(); q++ ) {
+    records[q].index = coreIndex[q];
+    records[q].value = raw[q];
+  }
+  char suffix[32];
+  snprintf( suffix, sizeof(suffix), ".tmp%d", (int)getpid() );
+  std::string tmpname = resultFileName( t ) + suffix;
+  std::ofstream rout( tmpname.c_str(), std::ios::binary );
+  rout.write( (char*)&rawMax, sizeof(double) );
+  rout.write( (char*)&records[0], sizeof(TileResult) * records.size() );
+  rout.close();
+  if( !rout || std::rename( tmpname.c_str(), resultFileName( t ).c_str() ) != 0 ) {
+    std::cout << "ERROR: Cannot write " << resultFileName( t ) << std::endl;
+    exit(1);
+  }
+  std::cout << std::endl;
+}
+
+//--- Settings of the workers ( the radius is written with all its digits )
+void tiledFeatureExtraction::writeJobFile( calculateFeature *ft )
+{
+  std::string tmpname = jobFileName() + ".tmp";
+  std::ofstream fout( tmpname.c_str() );
+  char radius[64];
+  snprintf( radius, sizeof(radius), "%.17g", ft->searchRadius() );
+  fout << TILE_JOBS << std::endl;
+  fout << TILE_JOB_NUM_TILES << "  " << m_numTiles << std::endl;
+  fout << TILE_JOB_RADIUS << "  " << radius << std::endl;
+  fout << TILE_JOB_FEATURE_VALUE_ID << "  " << (int)ft->featureValueID() << std::endl;
+  if( ft->expression() != NULL )
+    fout << TILE_JOB_EXPRESSION << "  " << ft->expression()->text() << std::endl;
+  fout << TILE_JOB_END_HEADER << std::endl;
+  fout.close();
+  if( !fout || std::rename( tmpname.c_str(), jobFileName().c_str() ) != 0 ) {
+    std::cout << "ERROR: Cannot write " << jobFileName() << std::endl;
+    exit(1);
+  }
+}
+
+void tiledFeatureExtraction::readJobFile( calculateFeature *ft )
+{
+  std::ifstream fin( jobFileName().c_str() );
+  if( !fin ) {
+    std::cout << "ERROR: No job file of a sharded run: " << jobFileName() << std::endl;
+    exit(1);
+  }
+
+  std::string line, expression;
+  double radius = 0.0;
+  int id = 0;
+  bool isJobs = false, isEnd = false;
+  m_numTiles = 0;
+  while( std::getline( fin, line ) ) {
+    std::istringstream words( line );
+    std::string command;
+    words >> command;
+    if( command == TILE_JOBS )
+      isJobs = true;
+    else if( command == TILE_JOB_NUM_TILES )
+      words >> m_numTiles;
+    else if( command == TILE_JOB_RADIUS )
+      words >> radius;
+    else if( command == TILE_JOB_FEATURE_VALUE_ID )
+      words >> id;
+    else if( command == TILE_JOB_EXPRESSION )
+      std::getline( words >> std::ws, expression );
+    else if( command == TILE_JOB_END_HEADER ) {
+      isEnd = true;
+      break;
+    }
+  }
+  if( !isJobs || !isEnd || m_numTiles <= 0 || radius <= 0.0 ) {
+    std::cout << "ERROR: Broken job file: " << jobFileName() << std::endl;
+    exit(1);
+  }
+
+  ft->setFeatureType( calculateFeature::PointPCA );
+  ft->setFeatureValueID( (calculateFeature::FeatureValueID)id );
+  if( !expression.empty() )
+    ft->setFeatureExpression( new featureExpression( expression.c_str() ) );
+  ft->setSearchRadius( radius );
+  ft->setFixedSearchRadius( true );
+  ft->setNormalization( false );
+}
+
+//--- Sharded run: local workers ( pfe -ocw ), then the tiles left by stopped workers
+void tiledFeatureExtraction::runWorkers( calculateFeature *ft )
+{
+  writeJobFile( ft );
+
+  std::vector<pid_t> workers;
+  for( int w = 0; w < m_numWorkers; w++ ) {
+    std::cout.flush();
+    pid_t pid = fork();
+    if( pid < 0 ) {
+      std::cout << "Cannot start worker " << w << std::endl;
+      break;
+    }
+    if( pid == 0 ) {
+      int fd = open( workerLogName( w ).c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+      if( fd >= 0 ) {
+        dup2( fd, STDOUT_FILENO );
+        dup2( fd, STDERR_FILENO );
+        close( fd );
+      }
+      execlp( m_program.c_str(), m_program.c_str(), m_inputFile, m_outputFile,
+              OUT_OF_CORE_WORKER_OPTION, (char*)NULL );
+      _exit( 127 );
+    }
+    workers.push_back( pid );
+  }
+  std::cout << "Workers: " << workers.size() << " processes ( log: "
+            << workerLogName( 0 ) << ", ... )" << std::endl;
+  std::cout << "Other workers can join: " << m_program << " " << m_inputFile << " "
+            << m_outputFile << " " << OUT_OF_CORE_WORKER_OPTION << std::endl;
+
+  int numTodo = 0;
+  for( int t = 0; t < m_numTiles; t++ )
+    if( m_tileCore[t] > 0 )
+      numTodo++;
+
+  int numDone = -1;
+  for(;;) {
+    for( size_t w = 0; w < workers.size(); ) {
+      int status;
+      if( waitpid( workers[w], &status, WNOHANG ) == workers[w] ) {
+        if( !WIFEXITED( status ) || WEXITSTATUS( status ) != 0 )
+          std::cout << "Worker " << workers[w] << " has stopped" << std::endl;
+        workers.erase( workers.begin() + w );
+      }
+      else
+        w++;
+    }
+
+    int done = 0;
+    for( int t = 0; t < m_numTiles; t++ )
+      if( m_tileCore[t] > 0 && isTileDone( t ) )
+        done++;
+    if( done != numDone ) {
+      std::cout << "Tiles done: " << done << " / " << numTodo << std::endl;
+      numDone = done;
+    }
+    if( done == numTodo )
+      break;
+
+    //--- No local worker: the tiles without a live claim are computed here
+    //    ( a stale claim of another host is taken over after CLAIM_TIMEOUT )
+    if( workers.empty() )
+      computeTiles( ft, true );
+    sleep( POLL_INTERVAL );
+  }
+  std::cout << std::endl;
+}
+
+//--- Pass 4: features in the input order ( windows of the budget ), normalized by the global maximum
+void tiledFeatureExtraction::mergeFeatures( double radius, int featureValueID )
+{
+  //--- Records and raw maximum of each tile
+  std::vector<unsigned long long> resultCount( m_numTiles, 0 );
+  unsigned long long numRecords = 0;
+  m_maxFeature = 0.0;
+  for( int t = 0; t < m_numTiles; t++ ) {
+    if( m_tileCore[t] == 0 )
+      continue;
+    std::ifstream rin( resultFileName( t ).c_str(), std::ios::binary | std::ios::ate );
+    size_t size = rin ? (size_t)rin.tellg() : 0;
+    double rawMax = 0.0;
+    rin.seekg( 0 );
+    if( size < sizeof(double) || !rin.read( (char*)&rawMax, sizeof(double) ) ) {
+      std::cout << "ERROR: No result of tile " << t << std::endl;
+      exit(1);
+    }
+    resultCount[t] = ( size - sizeof(double) ) / sizeof(TileResult);
+    numRecords += resultCount[t];
+    m_maxFeature = std::max( m_maxFeature, rawMax );
+  }
+  if( numRecords != m_number ) {
+    std::cout << "ERROR: " << numRecords << " results for " << m_number << " points" << std::endl;
+    exit(1);
+  }
+  std::cout << "Maximun of Sigma : " << m_maxFeature << std::endl;
+
+  std::vector<TileResult> chunk( MERGE_CHUNK );
+  std::vector<float> values( MERGE_CHUNK );
+
+  //--- Statistics of the normalized features ( one sequential pass over the results )
+  featureStatistics stats;
+  for( int t = 0; t < m_numTiles; t++ ) {
+    if( resultCount[t] == 0 )
+      continue;
+    std::ifstream rin( resultFileName( t ).c_str(), std::ios::binary );
+    rin.seekg( sizeof(double) );
+    for( unsigned long long begin = 0; begin < resultCount[t]; begin += MERGE_CHUNK ) {
+      size_t count = (size_t)std::min( (unsigned long long)MERGE_CHUNK, resultCount[t] - begin );
+      rin.read( (char*)&chunk[0], sizeof(TileResult) * count );
+      for( size_t k = 0; k < count; k++ )
+        values[k] = chunk[k].value / m_maxFeature;
+      stats.add( &values[0], count );
+    }
+  }
+  stats.finish();
+  stats.print();
+  stats.setParameters( radius, featureValueID, m_maxFeature );
+
+  std::ofstream fout( m_outputFile );
+  if( !fout ) {
+    std::cout << "ERROR: Cannot Open File " << m_outputFile << std::endl;
+    exit(1);
+  }
+  stats.write( fout );
+
+  size_t window = std::max( (size_t)1, m_budget / 2 / sizeof(float) );
+  std::vector<float> ft;
+  std::vector<unsigned long long> consumed( m_numTiles, 0 );
+  xyzPointStream in( m_inputFile );
+  float p[3], n[3];
+  unsigned char c[3];
+
+  for( size_t w0 = 0; w0 < m_number; w0 += window ) {
+    size_t w1 = std::min( m_number, w0 + window );
+    ft.assign( w1 - w0, 0.0f );
+
+    //--- Results of each tile are in the input order: read them up to the end of the window
+    for( int t = 0; t < m_numTiles; t++ ) {
+      if( consumed[t] == resultCount[t] )
+        continue;
+      std::ifstream rin( resultFileName( t ).c_str(), std::ios::binary );
+      rin.seekg( sizeof(double) + consumed[t] * sizeof(TileResult) );
+      while( consumed[t] < resultCount[t] ) {
+        size_t count = (size_t)std::min( (unsigned long long)MERGE_CHUNK, resultCount[t] - consumed[t] );
+        rin.read( (char*)&chunk[0], sizeof(TileResult) * count );
+        size_t k = 0;
+        for( ; k < count && chunk[k].index < w1; k++ )
+          ft[ chunk[k].index - w0 ] = chunk[k].value / m_maxFeature;
+        consumed[t] += k;
+        if( k < count )
+          break;
+      }
+    }
+
+    for( size_t i = w0; i < w1; i++ ) {
+      in.next( p, n, c );
+      fout << p[0] << " " << p[1] << " " << p[2] << " "
+           << n[0] << " " << n[1] << " " << n[2] << " "
+           << (int)c[0] << " " << (int)c[1] << " " << (int)c[2] << " "
+           << ft[i - w0] << std::endl;
+    }
+  }
+  fout.close();
+
+  std::cout << "Out-of-core output: " << m_outputFile << std::endl;
+}
+
+//--- Spill, claim and result files of the tiles, job file and worker logs
+void tiledFeatureExtraction::removeWorkFiles( void )
+{
+  for( int t = 0; t < m_numTiles; t++ ) {
+    std::remove( tileFileName( t ).c_str() );
+    std::remove( claimFileName( t ).c_str() );
+    std::remove( resultFileName( t ).c_str() );
+  }
+  std::remove( jobFileName().c_str() );
+  for( int w = 0; w < m_numWorkers; w++ )
+    std::remove( workerLogName( w ).c_str() );
+}
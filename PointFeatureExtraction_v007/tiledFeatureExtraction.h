@@ -0,0 +1,92 @@
+#ifndef _tiledFeatureExtraction_H__
+#define _tiledFeatureExtraction_H__
+
+#include <vector>
+#include <string>
+#include <ctime>
+#include "calculateFeature.h"
+
+//--- Out-of-core Point PCA for clouds larger than the memory
+//    1. The input is streamed to count the points in a grid of cells.
+//    2. The grid is split ( k-d ) into tiles until a tile and its halo
+//       ( the tile widened by the local-area radius ) fit in the memory budget.
+//    3. The input is streamed again and every point is written to the spill file of
+//       its tile ( core point ) and of the tiles whose halo contains it.
+//    4. Each tile is loaded and the features of its core points are computed with
+//       all the tile points as neighbors ( preview kernel of calculateFeature ),
+//       so that the features are the same as in-core. Results are written per tile.
+//    5. The results are merged into the input order in windows of the budget and
+//       normalized by the global maximum while the output file is written.
+//--- Sharded run ( setWorkers ): step 4 is done by worker processes ( pfe -ocw ).
+//    The coordinator writes the job file and starts the local workers. A worker claims
+//    a tile by creating its claim file ( O_EXCL ), so that workers on other machines
+//    can join through a shared file system. The coordinator tracks the result files,
+//    computes the tiles left by stopped workers, and merges the results. The owner of a
+//    claim touches it while computing; a claim of another host that has not been touched
+//    for a timeout is stale, and its tile is computed again.
+//    The tiles do not depend on the number of workers: the output is the same.
+class tiledFeatureExtraction {
+
+ public:
+  tiledFeatureExtraction( char* inputFile, char* outputFile, double budgetMB );
+
+  void setWorkers( int numWorkers, const char* program );
+  void exec( calculateFeature *ft );
+  void execWorker( calculateFeature *ft );
+
+ private:
+  struct KdNode
+  {
+    int axis;            // Split axis ( -1: leaf )
+    int split;           // Cell index of the split plane
+    double splitCoord;   // Coordinate of the split plane
+    int child[2];
+    int tile;            // Tile of a leaf
+  };
+
+  void scanBoundingBox( void );
+  void countCells( double radius );
+  unsigned long long boxCount( const int lo[3], const int hi[3] );
+  int buildTiles( const int lo[3], const int hi[3] );
+  void cellIndex( const float p[3], int c[3] );
+  int findTiles( const float p[3], std::vector<int> &tiles );
+  void distributePoints( void );
+  void computeTiles( calculateFeature *ft, bool isTakeOver );
+  void computeTile( calculateFeature *ft, int tile );
+  bool claimTile( int tile, bool isTakeOver );
+  void removeTempResults( int tile );
+  bool isTileDone( int tile );
+  void writeJobFile( calculateFeature *ft );
+  void readJobFile( calculateFeature *ft );
+  void runWorkers( calculateFeature *ft );
+  void mergeFeatures( double radius, int featureValueID );
+  void removeWorkFiles( void );
+  std::string tileFileName( int tile );
+  std::string claimFileName( int tile );
+  std::string resultFileName( int tile );
+  std::string jobFileName( void );
+  std::string workerLogName( int worker );
+
+ private:
+  char* m_inputFile;
+  char* m_outputFile;
+  size_t m_budget;                               // Memory budget in bytes
+  size_t m_maxTilePoints;                        // Points of a tile and its halo
+  size_t m_number;
+  float m_min[3], m_max[3];
+  double m_haloWidth;
+  double m_cellSize;
+  int m_numCells[3];
+  std::vector<unsigned long long> m_cellSum;     // Summed-area table of the cell counts
+  std::vector<KdNode> m_nodes;
+  std::vector<size_t> m_tileCore;                // Core points of each tile
+  int m_numTiles;
+  double m_maxFeature;                           // Global maximum before normalization
+  int m_numWorkers;                              // Local worker processes ( 0: single process )
+  std::string m_program;                         // Executable of the workers
+  std::string m_host;                            // Written in a claim file with the process ID
+  std::vector<time_t> m_claimTime;               // Last modification time seen of each claim file
+  std::vector<time_t> m_claimSeen;               // Time of this host when it was seen ( 0: not yet )
+};
+
+#endif
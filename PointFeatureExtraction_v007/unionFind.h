@@ -0,0 +1,41 @@
+#ifndef _unionFind_H__
+#define _unionFind_H__
+
+#include <vector>
+#include <atomic>
+#include <algorithm>
+
+//--- Union-find shared by the plane segmentation of pfe and the skeleton mode of alphaControl4ply
+//    parent[x] == x for a root. Threads may unite concurrently: the larger root is linked
+//    to the smaller one by compare-and-swap, and paths are halved while searching.
+inline size_t findRoot( std::vector< std::atomic<size_t> > &parent, size_t x )
+{
+  for (;;)
+  {
+    size_t p = parent[x].load();
+    if ( p == x )
+      return x;
+    size_t gp = parent[p].load();
+    if ( gp != p )
+      parent[x].compare_exchange_weak( p, gp );
+    x = gp;
+  }
+}
+
+inline void uniteRoots( std::vector< std::atomic<size_t> > &parent, size_t a, size_t b )
+{
+  for (;;)
+  {
+    a = findRoot( parent, a );
+    b = findRoot( parent, b );
+    if ( a == b )
+      return;
+    if ( a < b )
+      std::swap( a, b );
+    size_t expected = a;
+    if ( parent[a].compare_exchange_strong( expected, b ) )
+      return;
+  }
+}
+
+#endif
@@ -5,6 +5,8 @@
 #include <vector>
 #include <fstream>
 #include <cstdlib>
+#include "spcomment_xyz.h"
+#include "featureStatistics.h"
 
 enum WritingDataType {
     Ascii = 0,
@@ -14,10 +16,12 @@ enum WritingDataType {
 const float NORMAL[3] ={ 0.0, 0.0, 0.0 };
 const int COLOR[3] = {0, 255, 255};
 
+//--- stats: histogram and quantiles written to the header ( NULL: none )
 void writeFeature( kvs::PolygonObject *ply,
 	      std::vector<float> &ft,
 	      char* filename,
-	      WritingDataType type = Ascii )
+	      WritingDataType type = Ascii,
+	      featureStatistics *stats = NULL )
 {
   size_t num = ply->numberOfVertices();
   bool hasNormal = false, hasColor = false;;
@@ -32,8 +36,12 @@ void writeFeature( kvs::PolygonObject *ply,
     fout << "#/XYZ_BinaryData" << std::endl;
     fout << "#/NumParticles  " << num << std::endl;
     fout << "#/XYZDataType  XYZNormalColorFeature" << std::endl;
+    if( stats != NULL ) stats->write( fout );
     fout << "#/EndHeader" << std::endl;
   }
+  else if( stats != NULL ) {
+    stats->write( fout );
+  }
 
   for(int i=0; i<num; i++ ) {
     float x = coords[3*i];
@@ -83,5 +91,38 @@ void writeFeature( kvs::PolygonObject *ply,
   fout.close();
 }
 
+//--- Binary output of features at K radii: x y z f_1 ... f_K per point
+void writeMultiScaleFeature( kvs::PolygonObject *ply,
+                             std::vector<float> &msft,
+                             std::vector<double> &radii,
+                             const char* filename )
+{
+  size_t num = ply->numberOfVertices();
+  size_t K = radii.size();
+  kvs::ValueArray<kvs::Real32> coords = ply->coords();
+
+  std::ofstream fout( filename, std::ios::binary );
+  if( !fout ) {
+    std::cerr << "ERROR: Cannot Open File " << filename << std::endl;
+    exit(1);
+  }
+  fout << XYZ_BINARY << std::endl;
+  fout << XYZ_NUM_PARTICLES << "  " << num << std::endl;
+  fout << XYZ_DATA_TYPE << "  " << XYZ_MSF << std::endl;
+  fout << XYZ_NUM_SCALES << "  " << K << std::endl;
+  fout << XYZ_SCALE_RADII;
+  for( size_t k=0; k<K; k++ ) fout << " " << radii[k];
+  fout << std::endl;
+  fout << XYZ_END_HEADER << std::endl;
+
+  for( size_t i=0; i<num; i++ ) {
+    fout.write( (char*)&coords[3*i], sizeof(float)*3 );
+    fout.write( (char*)&msft[K*i], sizeof(float)*K );
+  }
+
+  fout.close();
+  std::cout << "** File " << filename << "  is generated." << std::endl;
+}
+
 
 #endif
@@ -16,7 +16,6 @@ class xyzAsciiReader: public kvs::PolygonObject
 
  private:
   void execRead( char* filename);
-  int breakWord( char* buf, std::string *str );
 
  private:
   char* m_filename;
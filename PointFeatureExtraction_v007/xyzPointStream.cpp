@@ -0,0 +1,138 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+#include "xyzPointStream.h"
+#include "asciiPointParser.h"
+#include "spcomment_xyz.h"
+
+const int BUF_MAX = 1024;
+const int MAX_WORDS = 15;
+const float NORM_DATA[3] = {0.0, 0.0, 0.0};
+const unsigned char COLOR_DATA[3] = {0, 200, 200};
+
+xyzPointStream::xyzPointStream( const char* filename ):
+  m_filename( filename ),
+  m_isBinary( false ),
+  m_numData( 3 ),
+  m_numVert( 0 ),
+  m_count( 0 )
+{
+  open();
+}
+
+int xyzPointStream::breakWord( char* buf, char **words )
+{
+  int n = 0;
+  char* data = strtok( buf, " \t\r" );
+  while( data != NULL && n < MAX_WORDS ) {
+    words[n++] = data;
+    data = strtok( NULL, " \t\r" );
+  }
+  return n;
+}
+
+//--- Header of a binary file, or the beginning of an ascii file
+void xyzPointStream::open( void )
+{
+  m_fin.open( m_filename.c_str(), std::ios::binary );
+  if( !m_fin ) {
+    std::cout << "ERROR: Cannot Open File: " << m_filename << std::endl;
+    exit(1);
+  }
+
+  char buf[ BUF_MAX ];
+  char *word[ MAX_WORDS ];
+  m_fin.getline( buf, BUF_MAX - 1, '\n' );
+  if( !strncmp( buf, "ply", 3 ) || !strncmp( buf, "#/SPBR", 6 ) ) {
+    std::cout << "ERROR: Out-of-core mode needs an xyz file ( ascii or binary ): " << m_filename << std::endl;
+    exit(1);
+  }
+
+  m_isBinary = !strncmp( buf, XYZ_BINARY, strlen( XYZ_BINARY ) );
+  m_count = 0;
+  if( !m_isBinary ) {
+    m_fin.clear();
+    m_fin.seekg( 0 );
+    return;
+  }
+
+  while( m_fin.getline( buf, BUF_MAX - 1, '\n' ) ) {
+    int nw = breakWord( buf, word );
+    if( nw == 0 )
+      continue;
+    if( !strcmp( word[0], XYZ_NUM_PARTICLES ) && nw > 1 )
+      m_numVert = atol( word[1] );
+    else if( !strcmp( word[0], XYZ_DATA_TYPE ) && nw > 1 ) {
+      if( !strcmp( word[1], XYZ_NCF ) )      m_numData = 10;
+      else if( !strcmp( word[1], XYZ_NC ) )  m_numData = 9;
+      else if( !strcmp( word[1], XYZ_N ) )   m_numData = 6;
+      else if( !strcmp( word[1], XYZ ) )     m_numData = 3;
+      else {
+        std::cout << "Out of Range in xyzPointStream" << std::endl;
+        exit(1);
+      }
+    }
+    else if( !strcmp( word[0], XYZ_END_HEADER ) )
+      return;
+  }
+}
+
+void xyzPointStream::rewind( void )
+{
+  m_fin.close();
+  m_fin.clear();
+  open();
+}
+
+//--- false: end of the file
+bool xyzPointStream::next( float p[3], float n[3], unsigned char c[3] )
+{
+  for( int k = 0; k < 3; k++ ) {
+    n[k] = NORM_DATA[k];
+    c[k] = COLOR_DATA[k];
+  }
+
+  if( m_isBinary ) {
+    if( m_count >= m_numVert )
+      return false;
+    m_fin.read( (char*)p, sizeof(float) * 3 );
+    if( m_numData >= 6 )
+      m_fin.read( (char*)n, sizeof(float) * 3 );
+    if( m_numData >= 9 )
+      m_fin.read( (char*)c, sizeof(unsigned char) * 3 );
+    if( m_numData >= 10 ) {
+      float f;
+      m_fin.read( (char*)&f, sizeof(float) );
+    }
+    if( !m_fin )
+      return false;
+    m_count++;
+    return true;
+  }
+
+  char buf[ BUF_MAX ];
+  double v[10];
+  while( m_fin.getline( buf, BUF_MAX - 1, '\n' ) ) {
+    if( buf[0] == '#' || buf[0] == '\0' || !strcmp( buf, "\r" ) )
+      continue;
+    int nw = asciiPointParser::parseLine( buf, buf + strlen( buf ), v, 10 );
+    if( nw < 3 ) {
+      std::cout << "Out of Reagion" << std::endl;
+      exit(1);
+    }
+    for( int k = 0; k < 3; k++ )
+      p[k] = (float)v[k];
+    if( nw >= 6 ) {
+      for( int k = 0; k < 3; k++ )
+        n[k] = (float)v[3+k];
+      if( nw >= 9 ) {
+        for( int k = 0; k < 3; k++ )
+          c[k] = (unsigned char)(long)v[6+k];
+      }
+    }
+    m_count++;
+    return true;
+  }
+  return false;
+}
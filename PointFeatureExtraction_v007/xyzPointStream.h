@@ -0,0 +1,34 @@
+#ifndef _xyzPointStream_H__
+#define _xyzPointStream_H__
+
+#include <fstream>
+#include <string>
+
+//--- Sequential reader of an xyz file ( ascii, or binary with #/XYZ_BinaryData )
+//    Points are read one by one without keeping them in memory ( out-of-core mode ).
+//    Missing normals and colors get the defaults of xyzAsciiReader / xyzBinaryReader.
+class xyzPointStream {
+
+ public:
+  xyzPointStream( const char* filename );
+
+  bool next( float p[3], float n[3], unsigned char c[3] );
+  void rewind( void );
+
+ private:
+  void open( void );
+  int breakWord( char* buf, char **words );
+
+ private:
+  std::string m_filename;
+  std::ifstream m_fin;
+  bool m_isBinary;
+  int m_numData;           // Values per point in a binary file ( 3, 6, 9 or 10 )
+  size_t m_numVert;        // Points in a binary file
+  size_t m_count;          // Points read so far
+
+ public:
+  bool isBinary( void ) { return m_isBinary; }
+};
+
+#endif
@@ -55,7 +55,7 @@ AlphaControlforPLY::AlphaControlforPLY(kvs::PolygonObject *plyObject,
   {
     std::cerr << "PLY data dosen't have polygons" << std::endl;
     int num = calculateRequiredPartcleNumber(alpha, repeatLevel, BBMin, BBMax);
-    calculatePointRaio(num, plyObject);
+    calculatePointRaio(num, plyObject, ft, threshold);
     setParticles(plyObject, ft, threshold);
   }
 }
@@ -122,29 +122,16 @@ double AlphaControlforPLY::calculateRequiredPartcleNumber(double alpha,
   return num;
 }
 
-void AlphaControlforPLY::calculatePointRaio(const double analyticalNum,
-                                            kvs::PolygonObject *ply)
+//-----------------------------------------------------------------------
+//  Measuring the point density around randomly selected points
+//  ( returns the number of points in a counting sphere )
+//-----------------------------------------------------------------------
+double AlphaControlforPLY::calculatePointDensity(octree *myTree,
+                                                 kvs::ValueArray<kvs::Real32> &coords,
+                                                 std::vector<size_t> &candidates)
 {
-  ply->updateMinMaxCoords();
-  kvs::ValueArray<kvs::Real32> coords = ply->coords();
   float *pdata = coords.data();
-  size_t numVert = ply->numberOfVertices();
-  kvs::Vector3f minBB = ply->minObjectCoord();
-  kvs::Vector3f maxBB = ply->maxObjectCoord();
-
-  double *mrange = new double[6];
-  mrange[0] = (double)minBB.x();
-  mrange[1] = (double)maxBB.x();
-  mrange[2] = (double)minBB.y();
-  mrange[3] = (double)maxBB.y();
-  mrange[4] = (double)minBB.z();
-  mrange[5] = (double)maxBB.z();
-
-  // create octree
-  std::cout << "Creating Octree... (Number of Vertex : " << numVert << std::endl;
-  std::cout << minBB << " \n"
-            << maxBB << std::endl;
-  octree *myTree = new octree(pdata, numVert, mrange, MIN_NODE);
+  size_t numCand = candidates.size();
   int num = 0;
   int execSearchNum = 0;
   double averageNearDist = 0.0;
@@ -155,9 +142,10 @@ void AlphaControlforPLY::calculatePointRaio(const double analyticalNum,
   std::cout << "Start OCtree Search..... " << std::endl;
   for (int i = 0; i < SEARCH_NUM; i++)
   {
-    size_t index = (size_t)((double)numVert * uniRand());
-    if (index == numVert)
-      --index;
+    size_t cand = (size_t)((double)numCand * uniRand());
+    if (cand == numCand)
+      --cand;
+    size_t index = candidates[cand];
     double point[3] = {coords[3 * index],
                        coords[3 * index + 1],
                        coords[3 * index + 2]};
@@ -190,6 +178,9 @@ void AlphaControlforPLY::calculatePointRaio(const double analyticalNum,
     num += n0;
     execSearchNum++;
   }
+  if (nearDistList.empty())
+    return 0.0;
+
   std::sort(nearDistList.begin(), nearDistList.end());
   averageNearDist = nearDistList[(int)(nearDistList.size() * 0.5)]; // intermediate value
   // Avarage for TRY_NUM calucrate sphere
@@ -201,32 +192,102 @@ void AlphaControlforPLY::calculatePointRaio(const double analyticalNum,
 
   double offset = averageNum / anaNumfromDreal;
 
-  std::cout << "==========================================" << std::endl;
-  std::cout << "Ana: " << analyticalNum << ", execNum: " << averageNum << std::endl;
+  std::cout << "execNum: " << averageNum << std::endl;
   std::cout << "Dist; " << averageNearDist << ", offset: " << offset << std::endl;
-  ;
   std::cout << "anaNumfromDreal: " << anaNumfromDreal << std::endl;
-  std::cout << "Ratio_Ana: " << (double)(analyticalNum / averageNum) << std::endl;
-  std::cout << "==========================================" << std::endl;
 
   if (offset > 1.0)
     offset = 1.0;
 
-  m_coeff4Ratio = ( anaNumfromDreal * offset );
-  m_ratio = analyticalNum / (anaNumfromDreal * offset);
+  return anaNumfromDreal * offset;
+}
+
+void AlphaControlforPLY::calculatePointRaio(const double analyticalNum,
+                                            kvs::PolygonObject *ply,
+                                            std::vector<float> &ft,
+                                            double threshold)
+{
+  ply->updateMinMaxCoords();
+  kvs::ValueArray<kvs::Real32> coords = ply->coords();
+  float *pdata = coords.data();
+  size_t numVert = ply->numberOfVertices();
+  kvs::Vector3f minBB = ply->minObjectCoord();
+  kvs::Vector3f maxBB = ply->maxObjectCoord();
+
+  double *mrange = new double[6];
+  mrange[0] = (double)minBB.x();
+  mrange[1] = (double)maxBB.x();
+  mrange[2] = (double)minBB.y();
+  mrange[3] = (double)maxBB.y();
+  mrange[4] = (double)minBB.z();
+  mrange[5] = (double)maxBB.z();
+
+  // create octree
+  std::cout << "Creating Octree... (Number of Vertex : " << numVert << std::endl;
+  std::cout << minBB << " \n"
+            << maxBB << std::endl;
+  octree *myTree = new octree(pdata, numVert, mrange, MIN_NODE);
+
+  // The density is measured separately for low-feature points and feature points,
+  // since a feature-aware downsampled data ( pds -ft ) keeps every feature point.
+  std::vector<size_t> lowInd, featureInd;
+  for (size_t i = 0; i < numVert; i++)
+  {
+    if (ft.size() == numVert && ft[i] >= threshold)
+      featureInd.push_back(i);
+    else
+      lowInd.push_back(i);
+  }
+
+  std::cout << "==========================================" << std::endl;
+  double coeffLow = 0.0, coeffFeature = 0.0;
+  if (!lowInd.empty())
+    coeffLow = calculatePointDensity(myTree, coords, lowInd);
+  if (!featureInd.empty())
+  {
+    std::cout << "---- Feature points" << std::endl;
+    coeffFeature = calculatePointDensity(myTree, coords, featureInd);
+  }
+  if (coeffLow <= 0.0 || coeffFeature <= 0.0)
+  {
+    std::vector<size_t> allInd(numVert);
+    for (size_t i = 0; i < numVert; i++)
+      allInd[i] = i;
+    double coeffAll = calculatePointDensity(myTree, coords, allInd);
+    if (coeffLow <= 0.0)
+      coeffLow = coeffAll;
+    if (coeffFeature <= 0.0)
+      coeffFeature = coeffAll;
+  }
+  std::cout << "Ana: " << analyticalNum << std::endl;
+  std::cout << "Ratio_Ana: " << (double)(analyticalNum / coeffLow) << std::endl;
+  std::cout << "==========================================" << std::endl;
+
+  m_coeff4Ratio = coeffFeature;
+  m_ratio = analyticalNum / coeffLow;
 
   std::cout << "Ratio for Alpha Control : " << m_ratio
-            << ", Diff : " << averageNum - analyticalNum << std::endl;
+            << ", Diff : " << coeffLow - analyticalNum << std::endl;
+
+  delete[] mrange;
 }
 
 void AlphaControlforPLY::setParticles(kvs::PolygonObject *ply, std::vector<float> &ft, double threshold)
 {
   size_t numVert = ply->numberOfVertices();
-  size_t createNum = (unsigned int)numVert * m_ratio;
+
+  // Particles are drawn only from the low-feature points, whose density gives m_ratio
+  std::vector<size_t> lowInd;
+  for (size_t i = 0; i < numVert; i++)
+    if (ft[i] < threshold)
+      lowInd.push_back(i);
+  size_t numLow = lowInd.size();
+
+  size_t createNum = (unsigned int)numLow * m_ratio;
   size_t multiNum = (unsigned int)m_ratio;
-  size_t oddNum = createNum - multiNum * numVert;
-  std::cout << "Number of Original Vertices : " << numVert << std::endl;
-  std::cout << "Number of setting Particles : " << createNum << "( " << multiNum * numVert << " + " << oddNum << " )" << std::endl;
+  size_t oddNum = createNum - multiNum * numLow;
+  std::cout << "Number of Original Vertices : " << numVert << " ( low feature: " << numLow << " )" << std::endl;
+  std::cout << "Number of setting Particles : " << createNum << "( " << multiNum * numLow << " + " << oddNum << " )" << std::endl;
   kvs::ValueArray<kvs::Real32> coords = ply->coords();
   kvs::ValueArray<kvs::Real32> normals = ply->normals();
   kvs::ValueArray<kvs::UInt8> colors = ply->colors();
@@ -242,42 +303,40 @@ void AlphaControlforPLY::setParticles(kvs::PolygonObject *ply, std::vector<float
   std::vector<unsigned int> counter;
   for (size_t i = 0; i < createNum; i++)
   {
-    size_t index = (size_t)((double)numVert * uniRand());
-    if (index == numVert)
-      --index;
+    size_t low = (size_t)((double)numLow * uniRand());
+    if (low == numLow)
+      --low;
+    size_t index = lowInd[low];
 
-    if (ft[index] < threshold)
-    {
-      counter.push_back(index);
+    counter.push_back(index);
 
-      SetCoords.push_back(coords[3 * index]);
-      SetCoords.push_back(coords[3 * index + 1]);
-      SetCoords.push_back(coords[3 * index + 2]);
+    SetCoords.push_back(coords[3 * index]);
+    SetCoords.push_back(coords[3 * index + 1]);
+    SetCoords.push_back(coords[3 * index + 2]);
 
-      if (ply->numberOfNormals() == numVert)
-      {
-        SetNormals.push_back(normals[3 * index]);
-        SetNormals.push_back(normals[3 * index + 1]);
-        SetNormals.push_back(normals[3 * index + 2]);
-      }
-      else
-      {
-        SetNormals.push_back(nom.x());
-        SetNormals.push_back(nom.y());
-        SetNormals.push_back(nom.z());
-      }
-      if (ply->numberOfColors() == numVert)
-      {
-        SetColors.push_back(colors[3 * index]);
-        SetColors.push_back(colors[3 * index + 1]);
-        SetColors.push_back(colors[3 * index + 2]);
-      }
-      else
-      {
-        SetColors.push_back(col.x());
-        SetColors.push_back(col.y());
-        SetColors.push_back(col.z());
-      }
+    if (ply->numberOfNormals() == numVert)
+    {
+      SetNormals.push_back(normals[3 * index]);
+      SetNormals.push_back(normals[3 * index + 1]);
+      SetNormals.push_back(normals[3 * index + 2]);
+    }
+    else
+    {
+      SetNormals.push_back(nom.x());
+      SetNormals.push_back(nom.y());
+      SetNormals.push_back(nom.z());
+    }
+    if (ply->numberOfColors() == numVert)
+    {
+      SetColors.push_back(colors[3 * index]);
+      SetColors.push_back(colors[3 * index + 1]);
+      SetColors.push_back(colors[3 * index + 2]);
+    }
+    else
+    {
+      SetColors.push_back(col.x());
+      SetColors.push_back(col.y());
+      SetColors.push_back(col.z());
     }
   }
 
@@ -5,6 +5,9 @@
 #include <kvs/PointObject>
 #include <kvs/PolygonObject>
 #include <kvs/Camera>
+#include <vector>
+
+class octree;
 
 class AlphaControlforPLY : public kvs::PointObject
 {
@@ -33,7 +36,12 @@ class AlphaControlforPLY : public kvs::PointObject
 							 kvs::Vector3f BBMin,
 							 kvs::Vector3f BBMax);
 	void calculatePointRaio(const double analyticalNum,
-							kvs::PolygonObject *ply);
+							kvs::PolygonObject *ply,
+							std::vector<float> &ft,
+							double threshold);
+	double calculatePointDensity(octree *myTree,
+								 kvs::ValueArray<kvs::Real32> &coords,
+								 std::vector<size_t> &candidates);
 	void setParticles(kvs::PolygonObject *ply, std::vector<float> &ft, double threshold);
 
   public:
@@ -42,6 +50,7 @@ class AlphaControlforPLY : public kvs::PointObject
 										  kvs::Vector3f BBMin,
 										  kvs::Vector3f BBMax);
 	double pointRatio(double anaNum);
+	double pixelWidth(void) { return m_pixel_width; }
 };
 
 #endif
@@ -1,9 +1,18 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#include <kvs/MersenneTwister>
+
 #include "FeaturePointExtraction.h"
+#include "featureStatistics.h"
 #include "octree.h"
+#include "unionFind.h"
 
 // Feature extraction type
 const int NORMAL_PFE_ID   = 0;
 const int ADAPTIVE_PFE_ID = 1;
+const int SKELETON_PFE_ID = 2;
 
 // Feature coloring type
 const int NORMAL_COLORING_ID   = 0;
@@ -20,6 +29,10 @@ const int MIN_NODE = 15;
 const std::string parameterList4PFE( "ParameterList.txt" );
 const std::string parameterList4AdaptivePFE_TypeB( "ParameterList_Type(b).txt" );
 const std::string parameterList4AdaptivePFE_TypeC( "ParameterList_Type(c).txt" );
+const std::string parameterList4SkeletonPFE( "ParameterList_Skeleton.txt" );
+
+const int SKELETON_KEY_BITS = 21;   // Bits per axis of a skeleton cell key
+const int POWER_ITERATION   = 20;   // Iterations for the principal direction
 
 FeaturePointExtraction::FeaturePointExtraction( void ) {
 }
@@ -38,7 +51,8 @@ FeaturePointExtraction::FeaturePointExtraction( kvs::PolygonObject *ply,
   // Select point feature extraction type
   std::cout << "\nFeature extraction type" << std::endl;
   std::cout << "Normal point feature extraction: " << NORMAL_PFE_ID << ", ";
-  std::cout << "Adaptive point feature extraction: " << ADAPTIVE_PFE_ID << std::endl;
+  std::cout << "Adaptive point feature extraction: " << ADAPTIVE_PFE_ID << ", ";
+  std::cout << "Skeleton point feature extraction: " << SKELETON_PFE_ID << std::endl;
 
   std::cout << "Select an ID >> ";
   std::cin >> pfeID;
@@ -72,6 +86,39 @@ FeaturePointExtraction::FeaturePointExtraction( kvs::PolygonObject *ply,
                                   fpoint,
                                   dirName );
   }
+  else if ( pfeID == SKELETON_PFE_ID )
+  {
+    skeletonAlphaControl4Feature( ply,
+                                  ft,
+                                  smallFth,
+                                  alphaMin,
+                                  repeatLevel,
+                                  imageResolution,
+                                  BBMin,
+                                  BBMax,
+                                  fpoint,
+                                  dirName );
+  }
+}
+
+//--- Principal direction of a 3x3 covariance ( xx, xy, xz, yy, yz, zz ) by power iteration
+static void principalDirection( const double cov[6], double e[3] )
+{
+  double v[3] = { 1.0, 1.0, 1.0 };
+  for ( int it = 0; it < POWER_ITERATION; it++ )
+  {
+    double w[3] = { cov[0] * v[0] + cov[1] * v[1] + cov[2] * v[2],
+                    cov[1] * v[0] + cov[3] * v[1] + cov[4] * v[2],
+                    cov[2] * v[0] + cov[4] * v[1] + cov[5] * v[2] };
+    double len = std::sqrt( w[0] * w[0] + w[1] * w[1] + w[2] * w[2] );
+    if ( len <= 0.0 )
+    {
+      e[0] = e[1] = e[2] = 0.0;
+      return;
+    }
+    v[0] = w[0] / len;  v[1] = w[1] / len;  v[2] = w[2] / len;
+  }
+  e[0] = v[0];  e[1] = v[1];  e[2] = v[2];
 }
 
 void FeaturePointExtraction::alpbaControl4Feature( kvs::PolygonObject *ply,
@@ -263,6 +310,10 @@ void FeaturePointExtraction::adaptiveAlphaControl4Feature( kvs::PolygonObject *p
   // s_th = tmpVector[ tmpVector.size() / 2 ];
   // s_th = std::accumulate( featuretVector.begin(), featuretVector.end(), 0.0 ) / featuretVector.size();
 
+  featureStatistics stats;
+  stats.calc( ft );
+  stats.printSwitchingThresholdSuggestions( smallFth );
+
   std::cout << "Input function switching threshold s_th>> ";
   std::cin >> s_th;
   std::cout << std::endl;
@@ -369,6 +420,278 @@ void FeaturePointExtraction::adaptiveAlphaControl4Feature( kvs::PolygonObject *p
   SuperClass::setColors( kvs::ValueArray<kvs::UInt8>( SetColors ) );
 }
 
+// --- Visualization by emitting highlight particles only along the skeletons of feature-point clusters.
+//     Feature points connected within the clustering radius form a cluster; each point is moved onto
+//     the principal line of its neighborhood, and the moved points are merged into skeleton samples.
+void FeaturePointExtraction::skeletonAlphaControl4Feature( kvs::PolygonObject *ply,
+                                                           std::vector<float> &ft,
+                                                           double smallFth,
+                                                           double alphaMin,
+                                                           int repeatLevel,
+                                                           int imageResolution,
+                                                           kvs::Vector3f BBMin,
+                                                           kvs::Vector3f BBMax,
+                                                           AlphaControlforPLY *fpoint,
+                                                           std::string dirName )
+{
+  // Select feature point color
+  std::cout << "\nHighlight color" << std::endl;
+  std::cout << "ORIGINAL: " << ORIGINAL_COLOR_ID << ", ";
+  std::cout << "RED: "      << RED_COLOR_ID      << ", ";
+  std::cout << "BLACK: "    << BLACK_COLOR_ID    << ", ";
+  std::cout << "CYAN: "     << CYAN_COLOR_ID     << std::endl;
+
+  std::cout << "Select an ID >> ";
+  std::cin >> colorID;
+
+  std::cout << "Highlight color ==> " << colorID << std::endl;
+  std::cout << std::endl;
+
+  size_t numVert = ply->numberOfVertices();
+  std::vector<int> ind;
+
+  int num = 0;
+  for ( size_t i = 0; i < numVert; i++ )
+  {
+    if ( ft[i] >= smallFth )
+    {
+      ind.push_back( i );
+      num++;
+    }
+  }
+  if ( num == 0 )
+  {
+    std::cout << "No feature points ( f_th = " << smallFth << " )" << std::endl;
+    return;
+  }
+
+  ply->updateMinMaxCoords();
+
+  kvs::ValueArray<kvs::Real32> coords  = ply->coords();
+  kvs::ValueArray<kvs::Real32> normals = ply->normals();
+
+  // Coordinates of the feature points
+  std::vector<float> fcoords( 3 * num );
+  kvs::Vector3f minBB = ply->minObjectCoord();
+  kvs::Vector3f maxBB = ply->maxObjectCoord();
+  for ( int i = 0; i < num; i++ )
+  {
+    fcoords[3 * i]     = coords[3 * ind[i]];
+    fcoords[3 * i + 1] = coords[3 * ind[i] + 1];
+    fcoords[3 * i + 2] = coords[3 * ind[i] + 2];
+  }
+
+  double *mrange = new double[6];
+  mrange[0] = (double)minBB.x();
+  mrange[1] = (double)maxBB.x();
+  mrange[2] = (double)minBB.y();
+  mrange[3] = (double)maxBB.y();
+  mrange[4] = (double)minBB.z();
+  mrange[5] = (double)maxBB.z();
+
+  // create octree
+  std::cout << "Creating Octree... (Number of Feature Points : " << num << std::endl;
+  std::cout << minBB << " \n"
+            << maxBB << std::endl;
+  std::cout << std::endl;
+  octree *myTree = new octree( fcoords.data(), num, mrange, MIN_NODE );
+
+  std::cout << "Clustering precision" << std::endl;
+  std::cout << "Input 1/clustering_radius (recommend the 1/local-area_radius used in pfe) >> ";
+  std::cin >> highlight_precision_inv;
+
+  kvs::Vector3f bb = maxBB - minBB;
+  double b_leng    = bb.length();
+  double radius    = b_leng / highlight_precision_inv;
+
+  std::cout << "\nInput opacity function parameters" << std::endl;
+  std::vector<double> alphaVec = calcOpacity( num, smallFth, alphaMin, ft, ind );
+
+  writeParameterList( smallFth,
+                      largeFth,
+                      alphaMin,
+                      alphaMax,
+                      dim,
+                      repeatLevel,
+                      imageResolution,
+                      parameterList4SkeletonPFE,
+                      dirName );
+
+  //--- Clustering and contraction onto the local principal line
+  std::cout << "Start OCtree Search..... " << std::endl;
+  std::vector< std::atomic<size_t> > parent( num );
+  for ( int i = 0; i < num; i++ )
+    parent[i].store( i );
+  std::vector<float> skelCoords( 3 * num );
+  std::vector<float> skelDir( 3 * num );
+
+#pragma omp parallel for schedule(dynamic, 256)
+  for ( int i = 0; i < num; i++ )
+  {
+    double point[3] = { fcoords[3 * i], fcoords[3 * i + 1], fcoords[3 * i + 2] };
+
+    vector<size_t> nearInd;
+    vector<double> dist;
+    search_points( point, radius, fcoords.data(), myTree->octreeRoot, &nearInd, &dist );
+    int n0 = (int)nearInd.size();
+
+    // Neighbors are weighted by their excess feature value, which pulls the centroid onto the crease
+    double c[3] = { 0.0, 0.0, 0.0 };
+    double sumW = 0.0;
+    for ( int j = 0; j < n0; j++ )
+    {
+      size_t k = nearInd[j];
+      if ( k > (size_t)i )
+        uniteRoots( parent, i, k );
+      double w = ft[ ind[k] ] - smallFth + 1.0e-6;
+      c[0] += w * fcoords[3 * k];  c[1] += w * fcoords[3 * k + 1];  c[2] += w * fcoords[3 * k + 2];
+      sumW += w;
+    }
+
+    double e[3] = { 0.0, 0.0, 0.0 };
+    double q[3] = { point[0], point[1], point[2] };
+    if ( n0 >= 3 )
+    {
+      c[0] /= sumW;  c[1] /= sumW;  c[2] /= sumW;
+      double cov[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+      for ( int j = 0; j < n0; j++ )
+      {
+        size_t k = nearInd[j];
+        double w = ft[ ind[k] ] - smallFth + 1.0e-6;
+        double d[3] = { fcoords[3 * k] - c[0], fcoords[3 * k + 1] - c[1], fcoords[3 * k + 2] - c[2] };
+        cov[0] += w * d[0] * d[0];  cov[1] += w * d[0] * d[1];  cov[2] += w * d[0] * d[2];
+        cov[3] += w * d[1] * d[1];  cov[4] += w * d[1] * d[2];  cov[5] += w * d[2] * d[2];
+      }
+      principalDirection( cov, e );
+
+      // The line passes through the neighbor with the largest feature value ( the crease itself ),
+      // since the centroid of a bent band lies off the surface
+      size_t top = nearInd[0];
+      for ( int j = 1; j < n0; j++ )
+        if ( ft[ ind[ nearInd[j] ] ] > ft[ ind[top] ] )
+          top = nearInd[j];
+      double a[3] = { fcoords[3 * top], fcoords[3 * top + 1], fcoords[3 * top + 2] };
+      double t = ( point[0] - a[0] ) * e[0] + ( point[1] - a[1] ) * e[1] + ( point[2] - a[2] ) * e[2];
+      q[0] = a[0] + t * e[0];  q[1] = a[1] + t * e[1];  q[2] = a[2] + t * e[2];
+    }
+    for ( int k = 0; k < 3; k++ )
+    {
+      skelCoords[3 * i + k] = q[k];
+      skelDir[3 * i + k]    = e[k];
+    }
+  }
+
+  //--- Skeleton samples: contracted points of one cluster merged on a grid
+  //    ( spacing: half the clustering radius, but not less than one pixel )
+  double pixelWidth = fpoint->pixelWidth();
+  double spacing    = std::max( 0.5 * radius, pixelWidth );
+  unsigned long long keyMax = ( 1ULL << SKELETON_KEY_BITS ) - 1;
+
+  std::vector< std::pair< std::pair<size_t, unsigned long long>, int > > keys( num );
+  int numCluster = 0;
+  for ( int i = 0; i < num; i++ )
+  {
+    size_t root = findRoot( parent, i );
+    if ( root == (size_t)i )
+      numCluster++;
+    unsigned long long cell[3];
+    for ( int k = 0; k < 3; k++ )
+    {
+      double g = ( skelCoords[3 * i + k] - mrange[2 * k] ) / spacing;
+      if ( g < 0.0 ) g = 0.0;
+      cell[k] = std::min( (unsigned long long)g, keyMax );
+    }
+    unsigned long long key = ( cell[0] << ( 2 * SKELETON_KEY_BITS ) ) | ( cell[1] << SKELETON_KEY_BITS ) | cell[2];
+    keys[i] = std::make_pair( std::make_pair( root, key ), i );
+  }
+  std::sort( keys.begin(), keys.end() );
+
+  //--- Particles per skeleton sample
+  //    A pixel on the line is covered by an ensemble with probability 1-(1-1/LR)^m,
+  //    so opacity alpha needs m = ln(1-alpha)/ln(1-1/LR) particles per pixel length.
+  std::vector<kvs::Real32> SetCoords;
+  std::vector<kvs::Real32> SetNormals;
+  kvs::MersenneTwister uniRand;
+  double logRepeat = ( repeatLevel > 1 ) ? std::log( 1.0 - 1.0 / repeatLevel ) : -1.0;
+  double perPointNum = 0.0;
+  int numSample = 0;
+
+  for ( int s = 0; s < num; )
+  {
+    int e = s;
+    while ( e < num && keys[e].first == keys[s].first )
+      e++;
+
+    double q[3] = { 0.0, 0.0, 0.0 };
+    double d[3] = { 0.0, 0.0, 0.0 };
+    double n[3] = { 0.0, 0.0, 0.0 };
+    double alpha = 0.0;
+    int ref      = keys[s].second;
+    int maxIndex = ref;
+    for ( int j = s; j < e; j++ )
+    {
+      int i = keys[j].second;
+      size_t index = ind[i];
+      double sign = ( skelDir[3 * i] * skelDir[3 * ref] +
+                      skelDir[3 * i + 1] * skelDir[3 * ref + 1] +
+                      skelDir[3 * i + 2] * skelDir[3 * ref + 2] < 0.0 ) ? -1.0 : 1.0;
+      for ( int k = 0; k < 3; k++ )
+      {
+        q[k] += skelCoords[3 * i + k];
+        d[k] += sign * skelDir[3 * i + k];
+        n[k] += normals[3 * index + k];
+      }
+      if ( alphaVec[i] > alpha )
+      {
+        alpha    = alphaVec[i];
+        maxIndex = i;
+      }
+      double a_num = fpoint->calculateRequiredPartcleNumber( alphaVec[i], repeatLevel, BBMin, BBMax );
+      perPointNum += std::ceil( fpoint->pointRatio( a_num ) );
+    }
+    double count = (double)( e - s );
+    double dlen  = std::sqrt( d[0] * d[0] + d[1] * d[1] + d[2] * d[2] );
+    double nlen  = std::sqrt( n[0] * n[0] + n[1] * n[1] + n[2] * n[2] );
+    for ( int k = 0; k < 3; k++ )
+    {
+      q[k] /= count;
+      d[k] = ( dlen > 0.0 ) ? d[k] / dlen : 0.0;
+      n[k] = ( nlen > 0.0 ) ? n[k] / nlen : 0.0;
+    }
+
+    if ( alpha > 0.99 )
+      alpha = 0.99;
+    double createNum = std::log( 1.0 - alpha ) / logRepeat * spacing / pixelWidth;
+
+    for ( int j = 0; j < createNum; j++ )
+    {
+      double t = ( uniRand() - 0.5 ) * spacing;
+      SetCoords.push_back( q[0] + t * d[0] );
+      SetCoords.push_back( q[1] + t * d[1] );
+      SetCoords.push_back( q[2] + t * d[2] );
+
+      SetNormals.push_back( n[0] );
+      SetNormals.push_back( n[1] );
+      SetNormals.push_back( n[2] );
+
+      setFeaturePointColor( ply, colorID, ind[maxIndex] );
+    }
+    numSample++;
+    s = e;
+  }
+
+  std::cout << "Number of clusters         : " << numCluster << std::endl;
+  std::cout << "Number of skeleton samples : " << numSample << " ( spacing: " << spacing << " )" << std::endl;
+  std::cout << "Number of highlight particles : " << SetCoords.size() / 3
+            << " ( per-point extraction: " << (size_t)perPointNum << " )" << std::endl;
+
+  delete[] mrange;
+
+  SuperClass::setCoords ( kvs::ValueArray<kvs::Real32>( SetCoords  ) );
+  SuperClass::setNormals( kvs::ValueArray<kvs::Real32>( SetNormals ) );
+  SuperClass::setColors( kvs::ValueArray<kvs::UInt8>( SetColors ) );
+}
+
 std::vector<double> FeaturePointExtraction::calcOpacity( int featurePointNum,
                                                          double smallFth,
                                                          double alphaMin,
@@ -378,6 +701,10 @@ std::vector<double> FeaturePointExtraction::calcOpacity( int featurePointNum,
   std::cout << "Maximum opacity α_max in range [" << alphaMin << ", 1] >> ";
   std::cin >> alphaMax;
 
+  featureStatistics stats;
+  stats.calc( featureValue );
+  stats.printLargeThresholdSuggestions( smallFth );
+
   std::cout << "Large feature value threshold F_th in range [" << smallFth << ", 1] >> ";
   std::cin >> largeFth;
 
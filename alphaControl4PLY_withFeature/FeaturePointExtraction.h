@@ -47,6 +47,17 @@ class FeaturePointExtraction: public kvs::PointObject {
 																		   AlphaControlforPLY *fpoint,
 																			 std::string dirName );
 
+		void skeletonAlphaControl4Feature( kvs::PolygonObject *ply,
+																			 std::vector<float> &ft,
+																			 double threshold,
+																			 double alphaMin,
+																			 int repeatLevel,
+																			 int imageResolution,
+																			 kvs::Vector3f BBMin,
+																			 kvs::Vector3f BBMax,
+																			 AlphaControlforPLY *fpoint,
+																			 std::string dirName );
+
 		std::vector<double> calcOpacity( int featurePointNum,
 																		 double threshold,
 																		 double alphaMin,
@@ -21,6 +21,7 @@
 #include "alp_option.h"
 #include "event_control.h"
 #include "FeaturePointExtraction.h"
+#include "featureStatistics.h"
 
 const double DEFAULT_CAMERA_DISTANCE = 12.0;
 
@@ -38,6 +39,14 @@ int main(int argc, char **argv)
   double smallFth;
   double alphaMin;
 
+  //--- Threshold suggestions from the feature statistics written by pfe
+  featureStatistics stats;
+  if (stats.read(argv[1]))
+  {
+    std::cout << std::endl;
+    stats.printSmallThresholdSuggestions();
+  }
+
   std::cout << "\nInput parameters" << std::endl;
   std::cout << "Repeat Level LR >> ";
   std::cin >> repeatLevel;